@@ -15,6 +15,7 @@ public:
     bool propagate(Solver& solver, Lit p) override;
     void calcReason(Solver& solver, Lit p, Lit extra, vec<Lit>& out_reason) override;
     void undo(Solver& solver, Lit p) override;
+    std::unique_ptr<Constraint> clone() const override { return std::make_unique<DirectEncodingExtensionSupports>(*this); }
 
 private:
     std::vector<std::vector<Lit>> vars_;
@@ -0,0 +1,212 @@
+#include "constraints/EncodingDetection.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace Glucose {
+
+bool ClauseCollector::addClause_(vec<Lit>& ps) {
+    clauses.emplace_back((const Lit*)ps, (const Lit*)ps + ps.size());
+    return true;
+}
+
+bool ClauseCollector::addClauses(const Lit* lits, const uint32_t* offsets, int n_clauses) {
+    for (int i = 0; i < n_clauses; ++i) {
+        clauses.emplace_back(lits + offsets[i], lits + offsets[i + 1]);
+    }
+    return true;
+}
+
+namespace {
+
+// Binary implication graph of the clauses, with a bounded search of the literals implied by a literal.
+class ImplicationGraph {
+public:
+    ImplicationGraph(int n_vars, const std::vector<std::vector<Lit>>& clauses, const std::vector<bool>& removed)
+        : imp_(2 * n_vars), stamp_(2 * n_vars, 0), current_(0), steps(0) {
+        for (size_t i = 0; i < clauses.size(); ++i) {
+            const std::vector<Lit>& c = clauses[i];
+            if (removed[i] || c.size() != 2 || var(c[0]) == var(c[1])) continue;
+            imp_[toInt(~c[0])].push_back(c[1]);
+            imp_[toInt(~c[1])].push_back(c[0]);
+        }
+    }
+
+    bool hasImplications(Lit p) const { return !imp_[toInt(p)].empty(); }
+
+    // Computes the literals implied by `p` (including itself), at most `limit` of them.
+    const std::vector<Lit>& reach(Lit p, int limit) {
+        ++current_;
+        reached_.clear();
+        reached_.push_back(p);
+        stamp_[toInt(p)] = current_;
+        for (size_t i = 0; i < reached_.size() && (int)reached_.size() < limit; ++i) {
+            for (Lit q : imp_[toInt(reached_[i])]) {
+                ++steps;
+                if (stamp_[toInt(q)] == current_) continue;
+                stamp_[toInt(q)] = current_;
+                reached_.push_back(q);
+            }
+        }
+        return reached_;
+    }
+
+    // Whether `p` was implied in the last call of `reach`.
+    bool reached(Lit p) const { return stamp_[toInt(p)] == current_; }
+
+private:
+    std::vector<std::vector<Lit>> imp_;
+    std::vector<int> stamp_;
+    std::vector<Lit> reached_;
+    int current_;
+
+public:
+    int64_t steps;
+};
+
+const int kReachLimit = 1000;
+
+void DetectXors(std::vector<std::vector<Lit>>& clauses, std::vector<bool>& removed, int max_xor_size,
+                DetectedEncodings& out) {
+    // (variables, signs, index) of the clauses of suitable size without repeated variables
+    std::vector<std::tuple<std::vector<Var>, uint32_t, int>> cands;
+    for (size_t i = 0; i < clauses.size(); ++i) {
+        if (clauses[i].size() < 3 || (int)clauses[i].size() > max_xor_size) continue;
+        std::vector<Lit> c = clauses[i];
+        std::sort(c.begin(), c.end());
+        bool repeated = false;
+        std::vector<Var> vars;
+        uint32_t signs = 0;
+        for (size_t j = 0; j < c.size(); ++j) {
+            repeated |= j > 0 && var(c[j - 1]) == var(c[j]);
+            vars.push_back(var(c[j]));
+            signs |= (uint32_t)sign(c[j]) << j;
+        }
+        if (!repeated) cands.emplace_back(std::move(vars), signs, (int)i);
+    }
+    std::sort(cands.begin(), cands.end());
+
+    for (size_t begin = 0, end; begin < cands.size(); begin = end) {
+        const std::vector<Var>& vars = std::get<0>(cands[begin]);
+        for (end = begin + 1; end < cands.size() && std::get<0>(cands[end]) == vars; ++end);
+
+        // A clause forbids the assignment given by its signs. The assignments forbidden by clauses
+        // with an even (resp. odd) number of negative literals leave the odd (resp. even) ones.
+        int n_distinct[2] = {0, 0};
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t signs = std::get<1>(cands[i]);
+            if (i == begin || signs != std::get<1>(cands[i - 1])) ++n_distinct[__builtin_popcount(signs) & 1];
+        }
+        for (int p = 0; p < 2; ++p) {
+            if (n_distinct[p] != 1 << (vars.size() - 1)) continue;
+            std::vector<Lit> lits;
+            for (Var v : vars) lits.push_back(mkLit(v));
+            out.xors.emplace_back(std::move(lits), 1 - p);
+            for (size_t i = begin; i < end; ++i) {
+                if ((__builtin_popcount(std::get<1>(cands[i])) & 1) == p) {
+                    removed[std::get<2>(cands[i])] = true;
+                    ++out.n_removed_clauses;
+                }
+            }
+        }
+    }
+}
+
+void DetectAtMostOnes(int n_vars, std::vector<std::vector<Lit>>& clauses, std::vector<bool>& removed,
+                      int min_amo_size, int64_t budget, DetectedEncodings& out) {
+    ImplicationGraph graph(n_vars, clauses, removed);
+
+    // Binary clauses by literal, to remove those of the pairwise encodings
+    std::vector<std::vector<std::pair<Lit, int>>> binaries(2 * n_vars);
+    for (size_t i = 0; i < clauses.size(); ++i) {
+        const std::vector<Lit>& c = clauses[i];
+        if (removed[i] || c.size() != 2) continue;
+        binaries[toInt(c[0])].emplace_back(c[1], (int)i);
+        binaries[toInt(c[1])].emplace_back(c[0], (int)i);
+    }
+
+    // `x` excludes `y` iff `x` implies `~y`. Literals excluding many others are tried first.
+    std::vector<int> n_excluded(2 * n_vars, 0);
+    std::vector<Lit> seeds;
+    for (int i = 0; i < 2 * n_vars && graph.steps < budget; ++i) {
+        Lit p = toLit(i);
+        if (!graph.hasImplications(p)) continue;
+        n_excluded[i] = graph.reach(p, kReachLimit).size() - 1;
+        seeds.push_back(p);
+    }
+    auto more_exclusions = [&](Lit x, Lit y) {
+        return n_excluded[toInt(x)] != n_excluded[toInt(y)] ? n_excluded[toInt(x)] > n_excluded[toInt(y)] : x < y;
+    };
+    std::sort(seeds.begin(), seeds.end(), more_exclusions);
+
+    std::vector<bool> covered(2 * n_vars, false), in_clique(n_vars, false), marked(2 * n_vars, false);
+    for (Lit x : seeds) {
+        if (graph.steps >= budget) break;
+        if (covered[toInt(x)]) continue;
+
+        std::vector<Lit> cands;
+        for (Lit q : graph.reach(x, kReachLimit)) {
+            if (var(q) != var(x) && graph.hasImplications(~q)) cands.push_back(~q);
+        }
+        std::sort(cands.begin(), cands.end(), more_exclusions);
+
+        // Greedily grow a clique of pairwise exclusive literals
+        std::vector<Lit> clique{x};
+        in_clique[var(x)] = true;
+        for (Lit y : cands) {
+            if (in_clique[var(y)]) continue;
+            graph.reach(y, kReachLimit);
+            bool exclusive = true;
+            for (Lit q : clique) exclusive &= graph.reached(~q);
+            if (exclusive) {
+                clique.push_back(y);
+                in_clique[var(y)] = true;
+            }
+        }
+        int n_uncovered = 0;
+        for (Lit q : clique) {
+            in_clique[var(q)] = false;
+            n_uncovered += !covered[toInt(q)];
+        }
+        // Cliques made mostly of already covered literals are usually weaker ones through
+        // auxiliary variables of an encoding
+        if (n_uncovered < min_amo_size) continue;
+
+        for (Lit q : clique) {
+            covered[toInt(q)] = true;
+            marked[toInt(~q)] = true;
+        }
+        for (Lit q : clique) {
+            for (auto [r, idx] : binaries[toInt(~q)]) {
+                if (marked[toInt(r)] && var(r) != var(q) && !removed[idx]) {
+                    removed[idx] = true;
+                    ++out.n_removed_clauses;
+                }
+            }
+        }
+        for (Lit q : clique) marked[toInt(~q)] = false;
+        out.at_most_ones.push_back(std::move(clique));
+    }
+}
+
+}
+
+DetectedEncodings DetectEncodings(int n_vars, std::vector<std::vector<Lit>>& clauses, int max_xor_size,
+                                  int min_amo_size, int64_t budget) {
+    DetectedEncodings ret;
+    std::vector<bool> removed(clauses.size(), false);
+
+    DetectXors(clauses, removed, std::min(max_xor_size, 20), ret);
+    DetectAtMostOnes(n_vars, clauses, removed, min_amo_size, budget, ret);
+
+    size_t j = 0;
+    for (size_t i = 0; i < clauses.size(); ++i) {
+        if (removed[i]) continue;
+        if (i != j) clauses[j] = std::move(clauses[i]);
+        ++j;
+    }
+    clauses.resize(j);
+    return ret;
+}
+
+}
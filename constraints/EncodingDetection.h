@@ -0,0 +1,44 @@
+#pragma once
+
+#include "core/SolverTypes.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Glucose {
+
+// Receives the clauses read by `parse_DIMACS` instead of a solver.
+class ClauseCollector {
+public:
+    int nVars() const { return n_vars_; }
+    Var newVar() { return n_vars_++; }
+    Var newVars(int n) { n_vars_ += n; return n_vars_ - n; }
+    bool addClause_(vec<Lit>& ps);
+    bool addClauses(const Lit* lits, const uint32_t* offsets, int n_clauses);
+
+    std::vector<std::vector<Lit>> clauses;
+
+private:
+    int n_vars_ = 0;
+};
+
+struct DetectedEncodings {
+    std::vector<std::vector<Lit>> at_most_ones;
+    std::vector<std::pair<std::vector<Lit>, int>> xors;  // Arguments of `Xor`
+    int n_removed_clauses = 0;
+};
+
+// Finds constraints encoded by `clauses` (over `n_vars` variables) which may be given to a solver
+// as native constraints:
+// - XOR constraints over 3 to `max_xor_size` variables, encoded by the clauses forbidding every
+//   assignment of the wrong parity. These clauses are removed.
+// - At-most-one constraints over at least `min_amo_size` literals which are pairwise exclusive in
+//   the binary implication graph. This covers the pairwise encoding, whose binary clauses are
+//   removed, as well as the ladder and sequential counter encodings, whose clauses are kept
+//   (auxiliary variables may be used elsewhere).
+// The search stops after about `budget` steps.
+DetectedEncodings DetectEncodings(int n_vars, std::vector<std::vector<Lit>>& clauses, int max_xor_size = 6,
+                                  int min_amo_size = 3, int64_t budget = 50000000);
+
+}
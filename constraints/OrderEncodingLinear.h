@@ -26,6 +26,7 @@ public:
     bool propagate(Solver& solver, Lit p) override;
     void calcReason(Solver& solver, Lit p, Lit extra, vec<Lit>& out_reason) override;
     void undo(Solver& solver, Lit p) override;
+    std::unique_ptr<Constraint> clone() const override { return std::make_unique<OrderEncodingLinear>(*this); }
 
 private:
     std::vector<LinearTerm> terms_;
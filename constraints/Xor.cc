@@ -87,6 +87,58 @@ void Xor::undo(Solver& solver, Lit p) {
     ++n_undecided_;
 }
 
+bool Xor::substitute(Solver& solver, Var v, Lit x) {
+    int idx = varIndex(v);
+    assert(vars_[idx] == v && value_[idx] == -1);
+    vars_.erase(vars_.begin() + idx);
+    value_.erase(value_.begin() + idx);
+    --n_undecided_;
+    if (sign(x)) parity_ ^= 1;
+
+    // A variable occurring twice cancels out
+    Var w = var(x);
+    int i = std::distance(vars_.begin(), std::lower_bound(vars_.begin(), vars_.end(), w));
+    if (i < vars_.size() && vars_[i] == w) {
+        assert(value_[i] == -1);
+        vars_.erase(vars_.begin() + i);
+        value_.erase(value_.begin() + i);
+        --n_undecided_;
+        solver.removeWatch(mkLit(w), this);
+        solver.removeWatch(mkLit(w, true), this);
+    } else {
+        vars_.insert(vars_.begin() + i, w);
+        value_.insert(value_.begin() + i, -1);
+        ++n_undecided_;
+        solver.addWatch(mkLit(w), this);
+        solver.addWatch(mkLit(w, true), this);
+    }
+
+    if (n_undecided_ == 0) return parity_ == 0;
+    if (n_undecided_ == 1) {
+        for (int j = 0; j < vars_.size(); ++j) {
+            if (value_[j] == -1) return solver.enqueue(mkLit(vars_[j], parity_ == 0), this);
+        }
+    }
+    return true;
+}
+
+void Xor::simplify(Solver& solver) {
+    // Assigned variables are already accounted for in 'parity_'
+    int j = 0;
+    for (int i = 0; i < vars_.size(); ++i) {
+        if (value_[i] == -1) {
+            vars_[j] = vars_[i];
+            value_[j] = -1;
+            ++j;
+        } else {
+            solver.removeWatch(mkLit(vars_[i]), this);
+            solver.removeWatch(mkLit(vars_[i], true), this);
+        }
+    }
+    vars_.resize(j);
+    value_.resize(j);
+}
+
 int Xor::varIndex(Var v) const {
     int i = std::distance(vars_.begin(), std::lower_bound(vars_.begin(), vars_.end(), v));
     assert(i < vars_.size());
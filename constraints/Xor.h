@@ -14,6 +14,10 @@ public:
     bool propagate(Solver& solver, Lit p) override;
     void calcReason(Solver& solver, Lit p, Lit extra, vec<Lit>& out_reason) override;
     void undo(Solver& solver, Lit p) override;
+    std::unique_ptr<Constraint> clone() const override { return std::make_unique<Xor>(*this); }
+    bool acceptsSubstitution() const override { return true; }
+    bool substitute(Solver& solver, Var v, Lit x) override;
+    void simplify(Solver& solver) override;
 
 private:
     int varIndex(Var v) const;
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/BinaryCNF.h"
+#include "core/Solver.h"
+
+using namespace Glucose;
+
+static const uint32_t binary_version = 1;
+static const int      header_words   = 9;
+
+static inline bool validLit(Lit l, int n_vars) { return toInt(l) >= 0 && var(l) < n_vars; }
+
+
+bool BinaryCNF::read(const char* data, size_t size)
+{
+    const uint32_t* w     = (const uint32_t*)data;
+    size_t          n     = size / sizeof(uint32_t);
+    if (n < (size_t)header_words || memcmp(data, "GCNF", 4) != 0 || w[1] != binary_version || w[2] != sizeof(Clause))
+        return false;
+
+    flags       = w[3];
+    n_vars      = w[4];
+    n_units     = w[5];
+    n_clauses   = w[6];
+    region_size = w[7];
+    int n_constraints = w[8];
+    if (n_vars < 0 || n_units < 0 || n_clauses < 0 || n_constraints < 0
+        || n - header_words < (size_t)n_units + n_clauses + region_size)
+        return false;
+
+    size_t pos = header_words;
+    units  = (const Lit*)(w + pos);   pos += n_units;
+    crefs  = (const CRef*)(w + pos);  pos += n_clauses;
+    region = w + pos;                 pos += region_size;
+
+    for (int i = 0; i < n_units; i++)
+        if (!validLit(units[i], n_vars)) return false;
+
+    // The clauses must lie in the region, and only be made of literals of the problem:
+    const size_t    header_size = sizeof(Clause) / sizeof(uint32_t);
+    const uint32_t  extra       = (flags & Abstractions) ? 2 : 0;
+    for (int i = 0; i < n_clauses; i++){
+        if (crefs[i] > region_size || region_size - crefs[i] < header_size) return false;
+        const Clause& c = *(const Clause*)(region + crefs[i]);
+        if (c.learnt() || c.hasId() || (uint32_t)c.extra_size() != extra || c.size() < 2
+            || (region_size - crefs[i] - header_size) < (size_t)c.size() + extra)
+            return false;
+        for (int j = 0; j < c.size(); j++)
+            if (!validLit(c[j], n_vars)) return false;
+    }
+
+    constraints.clear();
+    for (int i = 0; i < n_constraints; i++){
+        if (n - pos < 3 || n - pos - 3 < w[pos + 2]) return false;
+        BinaryConstraint constr;
+        constr.type  = w[pos];
+        constr.param = w[pos + 1];
+        if (constr.type != BinaryConstraint::AtMost && constr.type != BinaryConstraint::Xor) return false;
+        const Lit* lits = (const Lit*)(w + pos + 3);
+        constr.lits.assign(lits, lits + w[pos + 2]);
+        for (Lit l : constr.lits)
+            if (!validLit(l, n_vars)) return false;
+        pos += 3 + w[pos + 2];
+        constraints.push_back(std::move(constr));
+    }
+    return pos == n;
+}
+
+
+bool Glucose::isBinaryCNF(InputFile& in)
+{
+    return in.end() - in.begin() >= 4 && memcmp(in.begin(), "GCNF", 4) == 0;
+}
+
+
+void Glucose::loadBinaryCNF(InputFile& in, Solver& S, std::vector<BinaryConstraint>& constraints)
+{
+    // Compressed files are decompressed as a whole:
+    if (!in.isMapped())
+        while (in.refill(in.begin()));
+
+    BinaryCNF cnf;
+    if (!cnf.read(in.begin(), in.end() - in.begin()))
+        fprintf(stderr, "ERROR! Invalid binary CNF file, or written by another version.\n"), exit(3);
+    S.loadBinary(cnf);
+    constraints.swap(cnf.constraints);
+}
+
+
+//=================================================================================================
+// Solver methods:
+
+
+bool Solver::loadBinary(const BinaryCNF& cnf)
+{
+    assert(decisionLevel() == 0);
+    while (nVars() < cnf.n_vars) newVar();
+    if (!ok || (cnf.flags & BinaryCNF::Contradictory))
+        return ok = false;
+
+    vec<Lit> lits;
+    if (trail.size() > 0 || cnf.region_size == 0 || ca.clause_ids
+        || ca.extra_clause_field != ((cnf.flags & BinaryCNF::Abstractions) != 0)){
+        // The region cannot be used as such, the clauses are added one by one:
+        for (int i = 0; i < cnf.n_units; i++)
+            if (!addClause(cnf.units[i])) return false;
+        for (int i = 0; i < cnf.n_clauses; i++){
+            const Clause& c = *(const Clause*)(cnf.region + cnf.crefs[i]);
+            lits.clear();
+            for (int j = 0; j < c.size(); j++)
+                lits.push(c[j]);
+            if (!addClause_(lits)) return false; }
+        return true;
+    }
+
+    // The units are propagated after attaching the clauses, which watch unassigned literals:
+    for (int i = 0; i < cnf.n_units; i++)
+        if (!enqueue(cnf.units[i], CRef_Undef)) return ok = false;
+    CRef base = ca.append(cnf.region, cnf.region_size);
+    clauses.capacity(clauses.size() + cnf.n_clauses);
+    for (int i = 0; i < cnf.n_clauses; i++)
+        adoptClause(base + cnf.crefs[i]);
+    return ok = !hasConflict(propagate());
+}
+
+
+//=================================================================================================
+// Writing binary CNF files:
+
+
+static void writeWords(FILE* f, const uint32_t* w, size_t n)
+{
+    if (n > 0 && fwrite(w, sizeof(uint32_t), n, f) != n)
+        fprintf(stderr, "ERROR! Could not write binary CNF file.\n"), exit(1);
+}
+
+
+void Solver::toBinary(const char* file, const std::vector<BinaryConstraint>& constrs)
+{
+    assert(decisionLevel() == 0 && !ca.clause_ids);
+    FILE* f = fopen(file, "wb");
+    if (f == NULL)
+        fprintf(stderr, "could not open file %s\n", file), exit(1);
+
+    // Satisfied clauses are dropped, other ones are kept with their watches on unassigned literals:
+    vec<uint32_t> region;
+    vec<CRef>     crefs;
+    for (int i = 0; i < clauses.size(); i++){
+        const Clause& c = ca[clauses[i]];
+        if (c.mark() == 1 || satisfied(c)) continue;
+        const uint32_t* w = (const uint32_t*)&c;
+        crefs.push(region.size());
+        for (int j = 0, n = sizeof(Clause) / sizeof(uint32_t) + c.size() + c.extra_size(); j < n; j++)
+            region.push(w[j]);
+    }
+
+    uint32_t header[header_words];
+    memcpy(&header[0], "GCNF", 4);
+    header[1] = binary_version;
+    header[2] = sizeof(Clause);
+    header[3] = (ca.extra_clause_field ? BinaryCNF::Abstractions : 0) | (ok ? 0 : BinaryCNF::Contradictory);
+    header[4] = nVars();
+    header[5] = trail.size();
+    header[6] = crefs.size();
+    header[7] = region.size();
+    header[8] = constrs.size();
+    writeWords(f, header, header_words);
+    writeWords(f, (const uint32_t*)(const Lit*)trail, trail.size());
+    writeWords(f, (const uint32_t*)(const CRef*)crefs, crefs.size());
+    writeWords(f, (const uint32_t*)region, region.size());
+    for (const BinaryConstraint& c : constrs){
+        uint32_t w[3] = { (uint32_t)c.type, (uint32_t)c.param, (uint32_t)c.lits.size() };
+        writeWords(f, w, 3);
+        writeWords(f, (const uint32_t*)c.lits.data(), c.lits.size());
+    }
+    fclose(f);
+
+    if (verbosity > 0)
+        printf("Wrote %d clauses with %d variables.\n", crefs.size(), nVars());
+}
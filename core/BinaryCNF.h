@@ -0,0 +1,63 @@
+#ifndef Glucose_BinaryCNF_h
+#define Glucose_BinaryCNF_h
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "core/SolverTypes.h"
+#include "utils/InputFile.h"
+
+namespace Glucose {
+
+class Solver;
+
+//=================================================================================================
+// Binary CNF files, written by 'Solver::toBinary()' to skip parsing when a problem is solved again.
+// All fields are 32-bit words in the byte order of the machine:
+//
+//   "GCNF", version, sizeof(Clause), flags, #variables, #units, #clauses, region size, #constraints
+//   units        : one literal ('toInt()') per unit
+//   clauses      : offset of each clause in the region
+//   region       : the clauses as laid out by 'ClauseAllocator'
+//   constraints  : type, parameter, size and literals of each constraint
+//
+// The region is copied as a whole into the clause allocator of a solver without assignments, as
+// files are only read by builds with the same clause layout.
+
+struct BinaryConstraint {
+    enum Type { AtMost = 1, Xor = 2 };
+    int              type;
+    int              param;   // Bound of 'AtMost', parity of 'Xor'
+    std::vector<Lit> lits;
+};
+
+struct BinaryCNF {
+    enum { Abstractions = 1, Contradictory = 2 };
+
+    int             flags;
+    int             n_vars;
+    const Lit*      units;
+    int             n_units;
+    const CRef*     crefs;
+    int             n_clauses;
+    const uint32_t* region;
+    uint32_t        region_size;
+    std::vector<BinaryConstraint> constraints;
+
+    // Reads the file in ['data', 'data' + 'size'), which must be aligned on 32 bits, and checks
+    // that it is consistent. Returns FALSE if it is not a valid binary CNF file for this build.
+    bool read(const char* data, size_t size);
+};
+
+// Whether the beginning of the input is the one of a binary CNF file.
+bool isBinaryCNF(InputFile& in);
+
+// Inserts the problem of a binary CNF file into the solver, and its non-clausal constraints into
+// 'constraints'. Exits on invalid files, like the DIMACS parser.
+void loadBinaryCNF(InputFile& in, Solver& S, std::vector<BinaryConstraint>& constraints);
+
+//=================================================================================================
+}
+
+#endif
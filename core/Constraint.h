@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "mtl/Vec.h"
 #include "core/SolverTypes.h"
 
@@ -15,7 +17,34 @@ public:
     virtual bool initialize(Solver& solver) = 0;
     virtual bool propagate(Solver& solver, Lit p) = 0;
     virtual void calcReason(Solver& solver, Lit p, Lit extra, vec<Lit>& out_reason) = 0;
-    virtual void undo(Solver& solver, Lit p) {}
+    virtual void undo(Solver& /*solver*/, Lit /*p*/) {}
+
+    // A copy of the constraint in its current state, for a copy of the solver ('Solver::clone()').
+    // The copy must not refer to the original solver nor share mutable state with the original.
+    // By default, the constraint can not be copied: copying the solver is then an error.
+    virtual std::unique_ptr<Constraint> clone() const { return nullptr; }
+
+    // Optional support for simplification (at level 0, after propagation). 'SimpSolver' never
+    // eliminates the variables watched by a constraint, and substitutes them only if all these
+    // constraints accept substitutions. 'substitute()' replaces the unassigned variable 'v' by the
+    // unassigned literal 'x', watching 'x' as needed (the solver drops the watches of 'v'), and
+    // enqueues the literals it implies; it returns false on a conflict. 'simplify()' is called
+    // when new top-level assignments are found and may drop the assigned literals.
+    virtual bool acceptsSubstitution() const { return false; }
+    virtual bool substitute(Solver& /*solver*/, Var /*v*/, Lit /*x*/) { return false; }
+    virtual void simplify(Solver& /*solver*/) {}
+
+    // Optional support for DRAT proofs. With 'certifiedUNSAT', each explanation used by the solver
+    // is written as a lemma: (p v ~reason) for a propagation of 'p', and (~reason) for a conflict
+    // ('p' is lit_Undef). A checker only knows the clauses of the checked formula, so the
+    // constraint must have a clausal encoding there ('Solver::addConstraint()' rejects it
+    // otherwise), and the explanation must follow from it and the previous lemmas. It does by unit
+    // propagation for 'AtMost' with a pairwise or sequential counter encoding and for 'Xor' with
+    // its direct encoding, so they need no hook ('SimpSolver' does not substitute the variables of
+    // constraints in proofs). For weaker encodings, this hook is called just before the explanation
+    // is written, in the same state as 'calcReason()', to write the intermediate lemmas with
+    // 'Solver::writeProofClause()'.
+    virtual void certifyReason(Solver& /*solver*/, Lit /*p*/, const vec<Lit>& /*reason*/) {}
 
     int num_pending_propagation() const { return num_pending_propagation_; }
 
@@ -22,6 +22,14 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define Glucose_Dimacs_h
 
 #include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "utils/ParseUtils.h"
 #include "core/SolverTypes.h"
@@ -83,6 +91,149 @@ static void parse_DIMACS(gzFile input_stream, Solver& S) {
     StreamBuffer in(input_stream);
     parse_DIMACS_main(in, S); }
 
+template<class Solver>
+static void parse_DIMACS(InputFile& input, Solver& S) {
+    InputBuffer in(input);
+    parse_DIMACS_main(in, S); }
+
+//=================================================================================================
+// Parallel DIMACS Parser:
+//
+// A memory-mapped input is split into chunks after lines ending a clause. The chunks are parsed
+// by several threads, and their clauses are given to the solver by the calling thread, in the
+// order of the input or in the order the chunks are parsed.
+
+
+// Returns the position after the first complete line from 'p' ending a clause, or 'end'.
+static inline const char* nextClauseBoundary(const char* p, const char* end) {
+    p = (const char*)memchr(p, '\n', end - p);
+    if (p == NULL) return end;
+    for (p++; p < end;){
+        const char* nl = (const char*)memchr(p, '\n', end - p);
+        if (nl == NULL) return end;
+        const char* first = p;
+        const char* last  = nl;
+        while (first < last && (*first == ' ' || *first == '\t' || *first == '\r')) first++;
+        while (last > first && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r')) last--;
+        if (first < last && *first != 'c' && *first != 'p' && last[-1] == '0'
+            && (last - 1 == first || last[-2] == ' ' || last[-2] == '\t'))
+            return nl + 1;
+        p = nl + 1;
+    }
+    return end;
+}
+
+
+struct DimacsChunk {
+    std::vector<Lit>      lits;
+    std::vector<uint32_t> offsets;     // Clause i is 'lits[offsets[i]..offsets[i+1]-1]'
+    int                   max_var;
+    int                   vars;        // Header, if found in the chunk
+    int                   clauses;
+    bool                  header;
+    DimacsChunk() : offsets(1, 0), max_var(-1), vars(0), clauses(0), header(false) {}
+};
+
+
+// Parses the chunk ['begin', 'end') of data which may be read up to 'limit'.
+static inline void parseDimacsChunk(const char* begin, const char* end, const char* limit, DimacsChunk& out) {
+    MemoryBuffer in(begin, end, limit);
+    for (;;){
+        skipWhitespace(in);
+        if (*in == EOF) break;
+        else if (*in == 'p'){
+            if (eagerMatch(in, "p cnf")){
+                out.vars    = parseInt(in);
+                out.clauses = parseInt(in);
+                out.header  = true;
+            }else{
+                printf("PARSE ERROR! Unexpected char: %c\n", *in), exit(3);
+            }
+        } else if (*in == 'c')
+            skipLine(in);
+        else{
+            for (;;){
+                int parsed_lit = parseInt(in);
+                if (parsed_lit == 0) break;
+                int var = abs(parsed_lit)-1;
+                out.max_var = std::max(out.max_var, var);
+                out.lits.push_back( (parsed_lit > 0) ? mkLit(var) : ~mkLit(var) );
+            }
+            out.offsets.push_back(out.lits.size()); }
+    }
+}
+
+
+// Inserts the problem into the solver, parsing it with 'n_threads' threads. Inputs which are not
+// memory-mapped are parsed sequentially.
+//
+template<class Solver>
+static void parse_DIMACS_parallel(InputFile& input, Solver& S, int n_threads, bool ordered = true) {
+    if (n_threads <= 1 || !input.isMapped()){
+        parse_DIMACS(input, S);
+        return; }
+
+    const char* begin = input.begin();
+    const char* end   = input.end();
+    size_t      chunk_size = std::max((size_t)(end - begin) / (8 * n_threads), (size_t)1 << 20);
+    std::vector<const char*> bounds(1, begin);
+    while (bounds.back() < end)
+        bounds.push_back((size_t)(end - bounds.back()) > chunk_size ? nextClauseBoundary(bounds.back() + chunk_size, end) : end);
+
+    size_t                   n_chunks = bounds.size() - 1;
+    std::vector<DimacsChunk> chunks(n_chunks);
+    std::vector<char>        parsed(n_chunks, 0);
+    std::vector<size_t>      parse_order;
+    std::mutex               mutex;
+    std::condition_variable  cond;
+    std::atomic<size_t>      next(0);
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < n_threads && (size_t)i < n_chunks; i++)
+        workers.emplace_back([&](){
+            for (size_t c; (c = next++) < n_chunks;){
+                parseDimacsChunk(bounds[c], bounds[c+1], end, chunks[c]);
+                std::lock_guard<std::mutex> lock(mutex);
+                parsed[c] = 1;
+                parse_order.push_back(c);
+                cond.notify_one(); } });
+
+    int vars    = 0;
+    int clauses = 0;
+    int cnt     = 0;
+    for (size_t k = 0; k < n_chunks; k++){
+        size_t c;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (ordered){
+                c = k;
+                cond.wait(lock, [&](){ return parsed[c] != 0; });
+            }else{
+                cond.wait(lock, [&](){ return parse_order.size() > k; });
+                c = parse_order[k]; }
+        }
+
+        DimacsChunk& chunk = chunks[c];
+        if (chunk.header){
+            vars    = chunk.vars;
+            clauses = chunk.clauses; }
+        int n = chunk.offsets.size() - 1;
+        cnt += n;
+        if (chunk.max_var >= S.nVars())
+            S.newVars(chunk.max_var + 1 - S.nVars());
+        S.addClauses(chunk.lits.data(), chunk.offsets.data(), n);
+        std::vector<Lit>().swap(chunk.lits);
+        std::vector<uint32_t>().swap(chunk.offsets);
+    }
+    for (std::thread& t : workers)
+        t.join();
+
+    if (vars != S.nVars())
+        fprintf(stderr, "WARNING! DIMACS header mismatch: wrong number of variables.\n");
+    if (cnt  != clauses)
+        fprintf(stderr, "WARNING! DIMACS header mismatch: wrong number of clauses.\n");
+}
+
 //=================================================================================================
 }
 
@@ -0,0 +1,97 @@
+#include <stdlib.h>
+
+#include "core/ProofWriter.h"
+
+using namespace Glucose;
+
+
+ProofWriter::ProofWriter(FILE* o, bool b, int bs, int mb)
+  : out(o), binary(b), block_size(bs), max_blocks(mb)
+  , block(bs), used(0)
+  , writing(false), stopping(false), failed(false)
+{
+    writer = std::thread([this](){ run(); });
+}
+
+
+ProofWriter::~ProofWriter()
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cond.notify_all();
+    writer.join();
+}
+
+
+void ProofWriter::putInt(int n)
+{
+    if (n < 0) block[used++] = '-', n = -n;
+    char digits[10];
+    int  k = 0;
+    do digits[k++] = '0' + n % 10, n /= 10; while (n > 0);
+    while (k > 0) block[used++] = digits[--k];
+    block[used++] = ' ';
+}
+
+
+void ProofWriter::putId(uint64_t n)
+{
+    char digits[20];
+    int  k = 0;
+    do digits[k++] = '0' + n % 10, n /= 10; while (n > 0);
+    while (k > 0) block[used++] = digits[--k];
+    block[used++] = ' ';
+}
+
+
+void ProofWriter::handOff()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this](){ return (int)queue.size() < max_blocks || failed; });
+    if (failed)
+        fprintf(stderr, "ERROR! Could not write the proof.\n"), exit(1);
+
+    queue.emplace_back(std::move(block), used);
+    if (spare.empty())
+        block.assign(block_size, 0);
+    else{
+        block = std::move(spare.back());
+        spare.pop_back(); }
+    used = 0;
+    cond.notify_all();
+}
+
+
+void ProofWriter::flush()
+{
+    if (used > 0) handOff();
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this](){ return (queue.empty() && !writing) || failed; });
+    if (failed || fflush(out) != 0)
+        fprintf(stderr, "ERROR! Could not write the proof.\n"), exit(1);
+}
+
+
+void ProofWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;){
+        cond.wait(lock, [this](){ return !queue.empty() || stopping; });
+        if (queue.empty()) return;
+
+        std::pair<std::vector<char>, int> full = std::move(queue.front());
+        queue.pop_front();
+        writing = true;
+        lock.unlock();
+        bool ok = fwrite(full.first.data(), 1, full.second, out) == (size_t)full.second;
+        lock.lock();
+
+        writing = false;
+        failed |= !ok;
+        spare.push_back(std::move(full.first));
+        cond.notify_all();
+    }
+}
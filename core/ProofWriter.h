@@ -0,0 +1,104 @@
+#ifndef Glucose_ProofWriter_h
+#define Glucose_ProofWriter_h
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/SolverTypes.h"
+
+namespace Glucose {
+
+//=================================================================================================
+// DRAT and LRAT proof output: the proof is formatted (as text, or in the binary format if
+// 'binary') into blocks in memory, which a background thread writes to the file. When 'max_blocks'
+// full blocks are waiting to be written, the solver waits for the writer.
+//
+// A DRAT clause is written by 'beginClause()', 'addLit()' for each literal and 'endClause()'. An
+// LRAT lemma is written by 'beginLemma()', 'addLit()' for each literal, 'beginHints()', 'addId()'
+// for each hint and 'endClause()'; a deletion by 'beginDeletion()', 'addId()' for each deleted
+// clause and 'endClause()'.
+
+class ProofWriter {
+public:
+    ProofWriter(FILE* out, bool binary, int block_size = 1 << 20, int max_blocks = 16);
+    ~ProofWriter();  // Writes the remaining data and stops the thread, without closing the file
+
+    void beginClause(bool deletion) {
+        ensure(2);
+        if (binary) block[used++] = deletion ? 'd' : 'a';
+        else if (deletion) block[used++] = 'd', block[used++] = ' '; }
+
+    void addLit(Lit p) {
+        ensure(16);
+        if (binary) putVarint(toInt(p) + 2);
+        else        putInt(sign(p) ? -(var(p) + 1) : var(p) + 1); }
+
+    void beginLemma(uint64_t id) {
+        ensure(24);
+        if (binary) block[used++] = 'a', putVarint(2 * id);
+        else        putId(id); }
+
+    void beginHints() {
+        ensure(2);
+        if (binary) block[used++] = 0;
+        else        block[used++] = '0', block[used++] = ' '; }
+
+    void addId(uint64_t id) {
+        ensure(24);
+        if (binary) putVarint(2 * id);
+        else        putId(id); }
+
+    void beginDeletion(uint64_t last_id) {  // 'last_id' is the ID of the last lemma (text format)
+        ensure(26);
+        if (binary) block[used++] = 'd';
+        else        putId(last_id), block[used++] = 'd', block[used++] = ' '; }
+
+    void endClause() {
+        ensure(2);
+        if (binary) block[used++] = 0;
+        else        block[used++] = '0', block[used++] = '\n'; }
+
+    void flush();  // Waits until all the data is written
+
+private:
+    void ensure    (int n) { if (block_size - used < n) handOff(); }
+    void putVarint (uint64_t n) {
+        for (; n > 127; n >>= 7)
+            block[used++] = 128 | (n & 127);
+        block[used++] = n; }
+    void putInt    (int n);
+    void putId     (uint64_t n);
+    void handOff   ();    // Queues the current block and takes an empty one
+    void run       ();    // Body of the writer thread
+
+    FILE*             out;
+    bool              binary;
+    int               block_size;
+    int               max_blocks;
+
+    std::vector<char> block;     // Current block, of which 'used' bytes are filled
+    int               used;
+
+    std::mutex                                   mutex;
+    std::condition_variable                      cond;
+    std::deque<std::pair<std::vector<char>, int>> queue;  // Full blocks and their sizes
+    std::vector<std::vector<char>>               spare;
+    bool                                         writing;
+    bool                                         stopping;
+    bool                                         failed;
+    std::thread                                  writer;
+
+    ProofWriter(const ProofWriter&);
+    ProofWriter& operator=(const ProofWriter&);
+};
+
+//=================================================================================================
+}
+
+#endif
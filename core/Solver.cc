@@ -49,6 +49,8 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include <math.h>
 
+#include <unordered_map>
+
 #include "utils/System.h"
 #include "mtl/Sort.h"
 #include "core/Solver.h"
@@ -77,6 +79,10 @@ DOUBLE_OPTION(opt_K, _cr, "K", "The constant used to force restart", 0.8, Double
 DOUBLE_OPTION(opt_R, _cr, "R", "The constant used to block restart", 1.4, DoubleRange(1, false, 5, false));
 INT_OPTION(opt_size_lbd_queue, _cr, "szLBDQueue", "The size of moving average for LBD (restarts)", 50, IntRange(10, INT32_MAX));
 INT_OPTION(opt_size_trail_queue, _cr, "szTrailQueue", "The size of moving average for trail (block restarts)", 5000, IntRange(10, INT32_MAX));
+BOOL_OPTION(opt_stable_mode, _cr, "stable", "Alternate focused (glucose restarts) and stable (Luby restarts, target phases) modes", false);
+INT_OPTION(opt_stable_init, _cr, "stable-init", "The number of conflicts of the first focused mode", 1000, IntRange(1, INT32_MAX));
+DOUBLE_OPTION(opt_stable_inc, _cr, "stable-inc", "Growth factor of the mode lengths", 2, DoubleRange(1, true, HUGE_VAL, false));
+INT_OPTION(opt_rephase_int, _cr, "rephase-int", "Base number of conflicts between rephasings in stable mode, growing arithmetically (0=never)", 1000, IntRange(0, INT32_MAX));
 
 INT_OPTION(opt_first_reduce_db, _cred, "firstReduceDB", "The number of conflicts before the first reduce DB (or the size of leernts if chanseok is used)",
                                      2000, IntRange(0, INT32_MAX));
@@ -117,6 +123,24 @@ BOOL_OPTION(opt_fixed_randomize_phase_on_restarts, _cat, "fix-phas-rest", "Fixes
 BOOL_OPTION(opt_adapt, _cat, "adapt", "Adapt dynamically stategies after 100000 conflicts", true);
 
 BOOL_OPTION(opt_forceunsat, _cat,"forceunsat","Force the phase for UNSAT",true);
+
+BOOL_OPTION(opt_vivify, _cat, "vivify", "Periodically vivify learnt clauses of small LBD", false);
+INT_OPTION(opt_vivify_lbd, _cat, "vivify-lbd", "Maximum LBD of the vivified learnt clauses", 6, IntRange(2, INT32_MAX));
+DOUBLE_OPTION(opt_vivify_eff, _cat, "vivify-eff", "Propagations allowed for vivification, relative to search propagations", 0.1,
+                                     DoubleRange(0, false, HUGE_VAL, false));
+INT_OPTION(opt_vivify_int, _cat, "vivify-int", "The number of conflicts between vivification passes", 2000, IntRange(1, INT32_MAX));
+BOOL_OPTION(opt_probing, _cat, "probe", "Failed literal probing and hyper-binary resolution on the roots of the binary implication graph", false);
+INT_OPTION(opt_probe_int, _cat, "probe-int", "The number of conflicts between probing passes", 5000, IntRange(1, INT32_MAX));
+DOUBLE_OPTION(opt_probe_eff, _cat, "probe-eff", "Propagations allowed for probing, relative to search propagations", 0.05,
+                                     DoubleRange(0, true, HUGE_VAL, false));
+INT_OPTION(opt_probe_min, _cat, "probe-min", "Propagations always allowed for a probing pass", 100000, IntRange(0, INT32_MAX));
+INT_OPTION(opt_probe_hbr_max, _cat, "probe-hbr-max", "Hyper-binary resolvents added per probing pass", 1000, IntRange(0, INT32_MAX));
+INT_OPTION(opt_chrono, _cat, "chrono", "Backtrack chronologically when the jump is at least this many levels (-1=never)", -1, IntRange(-1, INT32_MAX));
+INT_OPTION(opt_confl_to_chrono, _cat, "confl-to-chrono", "The number of conflicts before chronological backtracking is allowed (-1=immediately)", 4000,
+                                     IntRange(-1, INT32_MAX));
+BOOL_OPTION(opt_trail_saving, _cat, "trail-saving", "Replay the implications removed by the last backtrack when they are still unit", false);
+BOOL_OPTION(opt_vmtf, _cat, "vmtf", "Use the VMTF queue instead of VSIDS for decisions", false);
+BOOL_OPTION(opt_adapt_vmtf, _cat, "adapt-vmtf", "Let the adaptive strategy switch between VMTF and VSIDS", false);
 //=================================================================================================
 // Constructor/Destructor:
 
@@ -148,10 +172,29 @@ verbosity(0)
 , rnd_pol(false)
 , rnd_init_act(opt_rnd_init_act)
 , randomizeFirstDescent(false)
+, chrono(opt_chrono)
+, confl_to_chrono(opt_confl_to_chrono)
+, trail_saving(opt_trail_saving)
+, vmtf(opt_vmtf)
+, adapt_vmtf(opt_adapt_vmtf)
+, stable_mode_switching(opt_stable_mode)
+, stable_init(opt_stable_init)
+, stable_inc(opt_stable_inc)
+, rephase_int(opt_rephase_int)
+, vivify(opt_vivify)
+, vivify_lbd(opt_vivify_lbd)
+, vivify_eff(opt_vivify_eff)
+, vivify_int(opt_vivify_int)
+, probing(opt_probing)
+, probe_int(opt_probe_int)
+, probe_eff(opt_probe_eff)
+, probe_min(opt_probe_min)
+, probe_hbr_max(opt_probe_hbr_max)
 , garbage_frac(opt_garbage_frac)
 , certifiedOutput(NULL)
 , certifiedUNSAT(false) // Not in the first parallel version
 , vbyte(false)
+, lrat(false)
 , dump_analysis_info(false)
 , panicModeLastRemoved(0), panicModeLastRemovedShared(0)
 , useUnaryWatched(false)
@@ -195,6 +238,28 @@ verbosity(0)
 , nbUnsatCalls(0)
 {
     MYFLAG = 0;
+    conflict_reason_valid = false;
+    saved_head = 0;
+    explain_propagations = false;
+    proof_id = 0;
+    lrat_trail = 0;
+    lrat_empty = false;
+    lrat_input = true;
+    lrat_n_queued = 0;
+    vmtf_time = 0;
+    vmtf_first = vmtf_last = vmtf_search = var_Undef;
+    stable = false;
+    next_mode_switch = 0;
+    mode_length = 0;
+    next_rephase = 0;
+    rephase_count = 0;
+    stable_restarts = 0;
+    target_assigned = best_assigned = 0;
+    next_vivify = 0;
+    vivify_props = 0;
+    next_probe = 0;
+    probe_props = 0;
+    probe_next = 0;
     // Initialize only first time. Useful for incremental solving (not in // version), useless otherwise
     // Kept here for simplicity
     lbdQueue.initSize(sizeLBDQueue);
@@ -233,9 +298,30 @@ Solver::Solver(const Solver &s) :
 , rnd_pol(s.rnd_pol)
 , rnd_init_act(s.rnd_init_act)
 , randomizeFirstDescent(s.randomizeFirstDescent)
+, chrono(s.chrono)
+, confl_to_chrono(s.confl_to_chrono)
+, trail_saving(s.trail_saving)
+, vmtf(s.vmtf)
+, adapt_vmtf(s.adapt_vmtf)
+, stable_mode_switching(s.stable_mode_switching)
+, stable_init(s.stable_init)
+, stable_inc(s.stable_inc)
+, rephase_int(s.rephase_int)
+, vivify(s.vivify)
+, vivify_lbd(s.vivify_lbd)
+, vivify_eff(s.vivify_eff)
+, vivify_int(s.vivify_int)
+, probing(s.probing)
+, probe_int(s.probe_int)
+, probe_eff(s.probe_eff)
+, probe_min(s.probe_min)
+, probe_hbr_max(s.probe_hbr_max)
 , garbage_frac(s.garbage_frac)
 , certifiedOutput(NULL)
 , certifiedUNSAT(false) // Not in the first parallel version
+, vbyte(false)
+, lrat(false)
+, dump_analysis_info(s.dump_analysis_info)
 , panicModeLastRemoved(s.panicModeLastRemoved), panicModeLastRemovedShared(s.panicModeLastRemovedShared)
 , useUnaryWatched(s.useUnaryWatched)
 , promoteOneWatchedClause(s.promoteOneWatchedClause)
@@ -254,7 +340,7 @@ Solver::Solver(const Solver &s) :
 , newDescent(s.newDescent)
 , randomDescentAssignments(s.randomDescentAssignments)
 , forceUnsatOnNewDescent(s.forceUnsatOnNewDescent)
-, ok(true)
+, ok(s.ok)
 , cla_inc(s.cla_inc)
 , var_inc(s.var_inc)
 , watches(WatcherDeleted(ca))
@@ -285,6 +371,14 @@ Solver::Solver(const Solver &s) :
 
     // Initialize  other variables
     MYFLAG = 0;
+    conflict_reason_valid = false;
+    saved_head = 0;
+    explain_propagations = false;
+    proof_id = 0;
+    lrat_trail = 0;
+    lrat_empty = false;
+    lrat_input = true;
+    lrat_n_queued = 0;
     // Initialize only first time. Useful for incremental solving (not in // version), useless otherwise
     // Kept here for simplicity
     sumLBD = s.sumLBD;
@@ -303,6 +397,28 @@ Solver::Solver(const Solver &s) :
     s.decision.memCopyTo(decision);
     s.trail.memCopyTo(trail);
     s.order_heap.copyTo(order_heap);
+    s.vmtf_links.memCopyTo(vmtf_links);
+    s.vmtf_stamp.memCopyTo(vmtf_stamp);
+    vmtf_time = s.vmtf_time;
+    vmtf_first = s.vmtf_first;
+    vmtf_last = s.vmtf_last;
+    vmtf_search = s.vmtf_search;
+    stable = s.stable;
+    next_mode_switch = s.next_mode_switch;
+    mode_length = s.mode_length;
+    next_rephase = s.next_rephase;
+    rephase_count = s.rephase_count;
+    stable_restarts = s.stable_restarts;
+    s.orig_polarity.memCopyTo(orig_polarity);
+    s.target_polarity.memCopyTo(target_polarity);
+    s.best_polarity.memCopyTo(best_polarity);
+    target_assigned = s.target_assigned;
+    best_assigned = s.best_assigned;
+    next_vivify = s.next_vivify;
+    vivify_props = s.vivify_props;
+    next_probe = s.next_probe;
+    probe_props = s.probe_props;
+    probe_next = s.probe_next;
     s.clauses.memCopyTo(clauses);
     s.learnts.memCopyTo(learnts);
     s.permanentLearnts.memCopyTo(permanentLearnts);
@@ -311,35 +427,33 @@ Solver::Solver(const Solver &s) :
     s.trailQueue.copyTo(trailQueue);
     s.forceUNSAT.copyTo(forceUNSAT);
     s.stats.copyTo(stats);
-}
 
-
-Solver::~Solver() {
+    // Clone the non-clause constraints, and redirect the watches, undo lists and reasons to the copies:
+    std::unordered_map<const Constraint*, Constraint*> copy_of;
+    copy_of[nullptr] = nullptr;
+    for(const std::unique_ptr<Constraint>& c : s.constraints) {
+        constraints.push_back(c->clone());
+        if(!constraints.back())
+            fprintf(stderr, "ERROR! A constraint that does not implement clone() can not be copied.\n"), exit(1);
+        copy_of[c.get()] = constraints.back().get();
+    }
+    constr_watches.growTo(s.constr_watches.size());
+    for(int i = 0; i < s.constr_watches.size(); i++)
+        for(int j = 0; j < s.constr_watches[i].size(); j++)
+            constr_watches[i].push(copy_of[s.constr_watches[i][j]]);
+    undoLists.growTo(s.undoLists.size());
+    for(int i = 0; i < s.undoLists.size(); i++)
+        for(int j = 0; j < s.undoLists[i].size(); j++)
+            undoLists[i].push(copy_of[s.undoLists[i][j]]);
+    for(int i = 0; i < vardata.size(); i++)
+        vardata[i].nc_reason = copy_of[vardata[i].nc_reason];
 }
 
 
-/****************************************************************
- Certified UNSAT proof in binary format
-****************************************************************/
-
-
-void Solver::write_char(unsigned char ch) {
-#ifdef _MSC_VER
-    if(putc((int) ch, certifiedOutput) == EOF)
-        exit(1);
-#else
-    if(putc_unlocked((int) ch, certifiedOutput) == EOF)
-        exit(1);
-#endif
+Solver::~Solver() {
 }
 
 
-void Solver::write_lit(int n) {
-    for(; n > 127; n >>= 7)
-        write_char(128 | (n & 127));
-    write_char(n);
-}
-
 /****************************************************************
  Set the incremental mode
 ****************************************************************/
@@ -390,16 +504,53 @@ Var Solver::newVar(bool sign, bool dvar) {
     seen.push(0);
     permDiff.push(0);
     polarity.push(sign);
+    orig_polarity.push(sign);
+    target_polarity.push(2);
+    best_polarity.push(2);
     forceUNSAT.push(0);
     decision.push();
     trail.capacity(v + 1);
     constr_watches.push();
     constr_watches.push();
     undoLists.push();
+    vmtf_links.push();
+    vmtf_stamp.push();
+    vmtfEnqueue(v);
     setDecisionVar(v, dvar);
     return v;
 }
 
+void Solver::reserveVars(int n) {
+    watches.capacity(2 * n);
+    watchesBin.capacity(2 * n);
+    unaryWatches.capacity(2 * n);
+    assigns.capacity(n);
+    vardata.capacity(n);
+    activity.capacity(n);
+    seen.capacity(n);
+    permDiff.capacity(n);
+    polarity.capacity(n);
+    orig_polarity.capacity(n);
+    target_polarity.capacity(n);
+    best_polarity.capacity(n);
+    forceUNSAT.capacity(n);
+    decision.capacity(n);
+    trail.capacity(n);
+    constr_watches.capacity(2 * n);
+    undoLists.capacity(n);
+    vmtf_links.capacity(n);
+    vmtf_stamp.capacity(n);
+    order_heap.capacity(n);
+}
+
+Var Solver::newVars(int n, bool sign, bool dvar) {
+    Var first = nVars();
+    reserveVars(first + n);
+    for(int i = 0; i < n; i++)
+        newVar(sign, dvar);
+    return first;
+}
+
 Var Solver::newNamedVar(const std::string& name) {
     int v = nVars();
     while (varNames.size() < v) {
@@ -412,6 +563,8 @@ Var Solver::newNamedVar(const std::string& name) {
 bool Solver::addClause_(vec <Lit> &ps) {
 
     assert(decisionLevel() == 0);
+    // Every input clause has its LRAT ID, even if it is dropped:
+    uint64_t id = certifiedUNSAT && lrat ? ++proof_id : 0;
     if(!ok) return false;
 
     // Check if clause is satisfied and remove false/duplicate literals:
@@ -437,28 +590,21 @@ bool Solver::addClause_(vec <Lit> &ps) {
             ps[j++] = p = ps[i];
     ps.shrink(i - j);
 
-    if(flag && (certifiedUNSAT)) {
-        if(vbyte) {
-            write_char('a');
-            for(i = j = 0, p = lit_Undef; i < ps.size(); i++)
-                write_lit(2 * (var(ps[i]) + 1) + sign(ps[i]));
-            write_lit(0);
-
-            write_char('d');
-            for(i = j = 0, p = lit_Undef; i < oc.size(); i++)
-                write_lit(2 * (var(oc[i]) + 1) + sign(oc[i]));
-            write_lit(0);
-        }
-        else {
-            for(i = j = 0, p = lit_Undef; i < ps.size(); i++)
-                fprintf(certifiedOutput, "%i ", (var(ps[i]) + 1) * (-2 * sign(ps[i]) + 1));
-            fprintf(certifiedOutput, "0\n");
-
-            fprintf(certifiedOutput, "d ");
-            for(i = j = 0, p = lit_Undef; i < oc.size(); i++)
-                fprintf(certifiedOutput, "%i ", (var(oc[i]) + 1) * (-2 * sign(oc[i]) + 1));
-            fprintf(certifiedOutput, "0\n");
-        }
+    if(certifiedUNSAT && lrat && ps.size() < oc.size()) {
+        // The false literals are removed with their unit clauses (checkers may not accept clauses
+        // with duplicate literals as units, so a lemma is written for these too)
+        lrat_hints.clear();
+        for(i = 0; i < oc.size(); i++)
+            if(value(oc[i]) == l_False && (i == 0 || oc[i] != oc[i - 1]))
+                lrat_hints.push(unit_ids[var(oc[i])]);
+        lrat_hints.push(id);
+        uint64_t old = id;
+        id = writeLemma(ps, lrat_hints);
+        lratDelete(old);
+        lrat_empty = ps.size() == 0;
+    } else if(flag && (certifiedUNSAT)) {
+        writeProofClause(ps);
+        writeProofClause(oc, true);
     }
 
 
@@ -466,9 +612,11 @@ bool Solver::addClause_(vec <Lit> &ps) {
         return ok = false;
     else if(ps.size() == 1) {
         uncheckedEnqueue(ps[0]);
+        if(id != 0) setUnitId(var(ps[0]), id);
         return ok = !hasConflict(propagate());
     } else {
         CRef cr = ca.alloc(ps, false);
+        if(id != 0) ca[cr].setId(id);
         clauses.push(cr);
         attachClause(cr);
     }
@@ -477,8 +625,99 @@ bool Solver::addClause_(vec <Lit> &ps) {
 }
 
 
-bool Solver::addConstraint(std::unique_ptr<Constraint>&& constr) {
+namespace {
+// Literals of a clause stored in a larger array, for 'ClauseAllocator::alloc()':
+struct LitRange {
+    const Lit *lits;
+    int sz;
+    LitRange(const Lit *l, int n) : lits(l), sz(n) {}
+    int size() const { return sz; }
+    Lit operator[](int i) const { return lits[i]; }
+};
+}
+
+
+bool Solver::addClauses(const Lit *lits, const uint32_t *offsets, int n_clauses) {
     assert(decisionLevel() == 0);
+
+    // Literals removed from clauses are logged one clause at a time (with LRAT, all the clauses
+    // get their IDs, even after a contradiction):
+    if(certifiedUNSAT) {
+        vec <Lit> ps;
+        for(int i = 0; i < n_clauses; i++) {
+            ps.clear();
+            for(uint32_t k = offsets[i]; k < offsets[i + 1]; k++)
+                ps.push(lits[k]);
+            if(!addClause_(ps) && !lrat) return false;
+        }
+        return ok;
+    }
+    if(!ok) return false;
+
+    // Simplify the clauses into 'simp' as in 'addClause_()', but propagate the units at the end:
+    int n_lits = offsets[n_clauses] - offsets[0];
+    vec <Lit> simp;
+    vec <uint32_t> ends;
+    simp.capacity(n_lits);
+    ends.capacity(n_clauses);
+    for(int i = 0; i < n_clauses; i++) {
+        int begin = simp.size();
+        for(uint32_t k = offsets[i]; k < offsets[i + 1]; k++) {
+            assert(var(lits[k]) < nVars());
+            simp.push_(lits[k]);
+        }
+        Lit *c = (Lit *) simp + begin;
+        int size = simp.size() - begin;
+        sort(c, size);
+
+        Lit p = lit_Undef;
+        bool satisfied = false;
+        int j = 0;
+        for(int k = 0; k < size && !satisfied; k++)
+            if(value(c[k]) == l_True || c[k] == ~p)
+                satisfied = true;
+            else if(value(c[k]) != l_False && c[k] != p)
+                c[j++] = p = c[k];
+
+        if(satisfied || j < 2) {
+            simp.shrink_(size);
+            if(satisfied) continue;
+            if(j == 0) return ok = false;
+            uncheckedEnqueue(c[0]);
+        } else {
+            simp.shrink_(size - j);
+            ends.push_(simp.size());
+        }
+    }
+
+    // Reserve the watcher lists (for large batches) and the clause memory once:
+    if(ends.size() >= nVars() / 4) {
+        vec <int> n_bin(2 * nVars(), 0), n_long(2 * nVars(), 0);
+        for(int i = 0, begin = 0; i < ends.size(); begin = ends[i++]) {
+            vec <int> &n = ends[i] - begin == 2 ? n_bin : n_long;
+            n[toInt(~simp[begin])]++;
+            n[toInt(~simp[begin + 1])]++;
+        }
+        for(int i = 0; i < 2 * nVars(); i++) {
+            if(n_bin[i] > 0) watchesBin[toLit(i)].capacity(watchesBin[toLit(i)].size() + n_bin[i]);
+            if(n_long[i] > 0) watches[toLit(i)].capacity(watches[toLit(i)].size() + n_long[i]);
+        }
+    }
+    ca.reserve(ends.size(), simp.size());
+    clauses.capacity(clauses.size() + ends.size());
+
+    for(int i = 0, begin = 0; i < ends.size(); begin = ends[i++])
+        adoptClause(ca.alloc(LitRange((const Lit *) simp + begin, ends[i] - begin), false));
+    return ok = !hasConflict(propagate());
+}
+
+
+bool Solver::addConstraint(std::unique_ptr<Constraint>&& constr, bool encoded) {
+    assert(decisionLevel() == 0);
+    if (lrat)
+        fprintf(stderr, "ERROR! Constraints can not be used with LRAT proofs.\n"), exit(1);
+    if (certifiedUNSAT && !encoded)
+        fprintf(stderr, "ERROR! Constraints without a clausal encoding in the formula cannot be certified.\n"), exit(1);
     if (!ok) return false;
 
     constraints.push_back(std::move(constr));
@@ -486,9 +725,13 @@ bool Solver::addConstraint(std::unique_ptr<Constraint>&& constr) {
     auto& constr_i = constraints.back();
     vec<Lit> ws;
 
+    int from = trail.size();
+    enqueue_failure = lit_Undef;
     if (!constr_i->initialize(*this)) {
+        if (certifiedUNSAT) explainPropagations(constr_i.get(), from, true);
         return ok = false;
     }
+    if (certifiedUNSAT) explainPropagations(constr_i.get(), from, false);
     for (int i = 0; i < ws.size(); ++i) {
         constr_watches[toInt(ws[i])].push(constr_i.get());
     }
@@ -504,6 +747,12 @@ void Solver::addWatch(Lit p, Constraint* constr) {
 }
 
 
+void Solver::removeWatch(Lit p, Constraint* constr) {
+    assert(decisionLevel() == 0);
+    remove(constr_watches[toInt(p)], constr);
+}
+
+
 void Solver::attachClause(CRef cr) {
     const Clause &c = ca[cr];
 
@@ -520,6 +769,12 @@ void Solver::attachClause(CRef cr) {
 }
 
 
+void Solver::adoptClause(CRef cr) {
+    clauses.push(cr);
+    attachClause(cr);
+}
+
+
 void Solver::attachClausePurgatory(CRef cr) {
     // TODO: this is used only by parallel solver, so currently not supported
     abort();
@@ -580,20 +835,7 @@ void Solver::removeClause(CRef cr, bool inPurgatory) {
 
     Clause &c = ca[cr];
 
-    if(certifiedUNSAT) {
-        if(vbyte) {
-            write_char('d');
-            for(int i = 0; i < c.size(); i++)
-                write_lit(2 * (var(c[i]) + 1) + sign(c[i]));
-            write_lit(0);
-        }
-        else {
-            fprintf(certifiedOutput, "d ");
-            for(int i = 0; i < c.size(); i++)
-                fprintf(certifiedOutput, "%i ", (var(c[i]) + 1) * (-2 * sign(c[i]) + 1));
-            fprintf(certifiedOutput, "0\n");
-        }
-    }
+    deleteFromProof(cr);
 
     if(inPurgatory)
         detachClausePurgatory(cr);
@@ -601,6 +843,7 @@ void Solver::removeClause(CRef cr, bool inPurgatory) {
         detachClause(cr);
     // Don't leave pointers to free'd memory!
     if(locked(c)) vardata[var(c[0])].reason = CRef_Undef;
+    if(saved_trail.size() > 0) clearSavedTrail();
     c.mark(1);
     ca.free(cr);
 }
@@ -681,6 +924,8 @@ void Solver::minimisationWithBinaryResolution(vec <Lit> &out_learnt) {
             if(permDiff[var(imp)] == MYFLAG && value(imp) == l_True) {
                 nb++;
                 permDiff[var(imp)] = MYFLAG - 1;
+                if(lrat)
+                    lrat_bin.push(wbin[k].cref);
             }
         }
         int l = out_learnt.size() - 1;
@@ -703,18 +948,38 @@ void Solver::minimisationWithBinaryResolution(vec <Lit> &out_learnt) {
 }
 
 // Revert to the state at given level (keeping all assignment at 'level' but not beyond).
+// With chronological backtracking, literals assigned out of order at a level <= 'level' are kept
+// and put back on the trail. Custom constraints are notified of their undo as well, so these
+// literals are propagated again from 'qhead'.
+// With trail saving, the removed part of the trail is remembered so that 'propagate()' can replay it.
 //
 
 void Solver::cancelUntil(int level) {
     if(decisionLevel() > level) {
+        if(trail_saving) {
+            clearSavedTrail();
+            for(int c = trail_lim[level]; c < trail.size(); c++) {
+                Var x = var(trail[c]);
+                if(vardata[x].level <= level) continue;
+                saved_trail.push(trail[c]);
+                saved_reasons.push(nc_reason(x) == nullptr ? reason(x) : CRef_Undef);
+            }
+        }
+        cancel_kept.clear();
         for(int c = trail.size() - 1; c >= trail_lim[level]; c--) {
             Lit p = trail[c];
             Var x = var(p);
-            assigns[x] = l_Undef;
-            if(phase_saving > 1 || ((phase_saving == 1) && c > trail_lim.last())) {
-                polarity[x] = sign(trail[c]);
+            if(c >= qhead)
+                addNumPendingPropagation(p, -1);
+            if(vardata[x].level <= level) {
+                cancel_kept.push(p);
+            } else {
+                assigns[x] = l_Undef;
+                if(phase_saving > 1 || ((phase_saving == 1) && c > trail_lim.last())) {
+                    polarity[x] = sign(trail[c]);
+                }
+                insertVarOrder(x);
             }
-            insertVarOrder(x);
             while (undoLists[x].size() > 0) {
                 undoLists[x].last()->undo(*this, p);
                 undoLists[x].pop();
@@ -723,6 +988,10 @@ void Solver::cancelUntil(int level) {
         qhead = trail_lim[level];
         trail.shrink(trail.size() - trail_lim[level]);
         trail_lim.shrink(trail_lim.size() - level);
+        for(int i = cancel_kept.size() - 1; i >= 0; i--) {
+            trail.push_(cancel_kept[i]);
+            addNumPendingPropagation(cancel_kept[i], 1);
+        }
     }
 }
 
@@ -734,14 +1003,18 @@ Lit Solver::pickBranchLit() {
     Var next = var_Undef;
 
     // Random decision:
-    if(((randomizeFirstDescent && conflicts == 0) || drand(random_seed) < random_var_freq) && !order_heap.empty()) {
-        next = order_heap[irand(random_seed, order_heap.size())];
+    if(((randomizeFirstDescent && conflicts == 0) || drand(random_seed) < random_var_freq) && (vmtf ? nVars() > 0 : !order_heap.empty())) {
+        next = vmtf ? irand(random_seed, nVars()) : order_heap[irand(random_seed, order_heap.size())];
         if(value(next) == l_Undef && decision[next])
             stats[rnd_decisions]++;
     }
 
+    // VMTF decision:
+    if(vmtf && (next == var_Undef || value(next) != l_Undef || !decision[next]))
+        next = vmtfNextVar();
+
     // Activity based decision:
-    while(next == var_Undef || value(next) != l_Undef || !decision[next])
+    while(!vmtf && (next == var_Undef || value(next) != l_Undef || !decision[next]))
         if(order_heap.empty()) {
             next = var_Undef;
             break;
@@ -766,6 +1039,9 @@ Lit Solver::pickBranchLit() {
 
     }
 
+    if(stable && !rnd_pol && target_polarity[next] != 2)
+        return mkLit(next, target_polarity[next]);
+
     return next == var_Undef ? lit_Undef : mkLit(next, rnd_pol ? drand(random_seed) < 0.5 : polarity[next]);
 }
 
@@ -779,7 +1055,8 @@ Lit Solver::pickBranchLit() {
 |  
 |    Pre-conditions:
 |      * 'out_learnt' is assumed to be cleared.
-|      * Current decision level must be greater than root level.
+|      * 'confl_level' is the highest level in the conflict, greater than root level. It is the
+|        current decision level unless chronological backtracking is used.
 |  
 |    Post-conditions:
 |      * 'out_learnt[0]' is the asserting literal at level 'out_btlevel'.
@@ -787,7 +1064,7 @@ Lit Solver::pickBranchLit() {
 |        rest of literals. There may be others from the same level though.
 |  
 |________________________________________________________________________________________________@*/
-void Solver::analyze(CRef confl, Constraint* constr, vec <Lit> &out_learnt, vec <Lit> &selectors, int &out_btlevel, unsigned int &lbd, unsigned int &szWithoutSelectors) {
+void Solver::analyze(CRef confl, Constraint* constr, int confl_level, vec <Lit> &out_learnt, vec <Lit> &selectors, int &out_btlevel, unsigned int &lbd, unsigned int &szWithoutSelectors) {
     int pathC = 0;
     Lit p = lit_Undef;
     vec<Lit> p_reason;
@@ -804,8 +1081,15 @@ void Solver::analyze(CRef confl, Constraint* constr, vec <Lit> &out_learnt, vec
         if (constr != nullptr) {
             // TODO: add optimizations for custom constraints, too
             p_reason.clear();
-            constr->calcReason(*this, p, extra, p_reason);
+            if (p == lit_Undef && conflict_reason_valid) {
+                conflict_reason.copyTo(p_reason);
+                conflict_reason_valid = false;
+            } else {
+                constr->calcReason(*this, p, extra, p_reason);
+            }
             extra = lit_Undef;
+            if (certifiedUNSAT)
+                explainToProof(constr, p, p_reason);
 
             if (dump_analysis_info) {
                 printf("propagate reason:");
@@ -824,7 +1108,7 @@ void Solver::analyze(CRef confl, Constraint* constr, vec <Lit> &out_learnt, vec
                 if (!seen[var(q)] && level(var(q)) > 0) {
                     varBumpActivity(var(q));
                     seen[var(q)] = 1;
-                    if (level(var(q)) >= decisionLevel())
+                    if (level(var(q)) >= confl_level)
                         pathC++;
                     else
                         out_learnt.push(~q);
@@ -896,7 +1180,7 @@ void Solver::analyze(CRef confl, Constraint* constr, vec <Lit> &out_learnt, vec
                         bumpForceUNSAT(~q); // Negation because q is false here
 
                         seen[var(q)] = 1;
-                        if(level(var(q)) >= decisionLevel()) {
+                        if(level(var(q)) >= confl_level) {
                             pathC++;
                             // UPDATEVARACTIVITY trick (see competition'09 companion paper)
                             if(!isSelector(var(q)) && (reason(var(q)) != CRef_Undef) && ca[reason(var(q))].learnt())
@@ -914,8 +1198,11 @@ void Solver::analyze(CRef confl, Constraint* constr, vec <Lit> &out_learnt, vec
         }
 
         // Select next clause to look at:
+        // (literals of lower levels may appear above it on the trail after chronological backtracking)
         int index_pre = index;
-        while (!seen[var(trail[index--])]);
+        do {
+            while (!seen[var(trail[index--])]);
+        } while (level(var(trail[index + 1])) < confl_level);
         for (int i = index_pre; i > index; --i) {
             Lit p = trail[i];
             Var x = var(p);
@@ -1030,6 +1317,8 @@ void Solver::analyze(CRef confl, Constraint* constr, vec <Lit> &out_learnt, vec
         }
         lastDecisionLevel.clear();
     }
+    if(vmtf)
+        vmtfBumpQueue();
 
 
     for(int j = 0; j < analyze_toclear.size(); j++) seen[var(analyze_toclear[j])] = 0; // ('seen[]' is now cleared)
@@ -1079,6 +1368,64 @@ bool Solver::litRedundant(Lit p, uint32_t abstract_levels) {
 }
 
 
+/*_________________________________________________________________________________________________
+|
+|  findConflictLevel : (confl : pair<CRef, Constraint*>) (single : bool&)  ->  [int]
+|  
+|  Description:
+|    Used with chronological backtracking, where a conflict may not involve the current decision
+|    level. Returns the highest level among the literals of the conflict. For a clause, 'single'
+|    tells whether only one literal is at this level (a missed lower implication); the clause is
+|    then reordered so that this literal is 'c[0]' and the next highest one is 'c[1]'.
+|    The explanation of a conflicting constraint is kept in 'conflict_reason' for 'analyze()'.
+|________________________________________________________________________________________________@*/
+int Solver::findConflictLevel(std::pair<CRef, Constraint*> confl, bool& single) {
+    single = false;
+
+    if (confl.second != nullptr) {
+        conflict_reason.clear();
+        confl.second->calcReason(*this, lit_Undef, enqueue_failure, conflict_reason);
+        conflict_reason_valid = true;
+
+        int highest = 0;
+        for (int i = 0; i < conflict_reason.size(); i++)
+            if (level(var(conflict_reason[i])) > highest)
+                highest = level(var(conflict_reason[i]));
+        return highest;
+    }
+
+    CRef cr = confl.first;
+    Clause &c = ca[cr];
+    if(level(var(c[0])) == decisionLevel() && level(var(c[1])) == decisionLevel())
+        return decisionLevel();
+
+    // Move the two highest literals to the front:
+    int first = 0, second = 1;
+    if(level(var(c[1])) > level(var(c[0])))
+        first = 1, second = 0;
+    for(int i = 2; i < c.size(); i++) {
+        if(level(var(c[i])) > level(var(c[first]))) {
+            second = first;
+            first = i;
+        } else if(level(var(c[i])) > level(var(c[second])))
+            second = i;
+    }
+    int highest = level(var(c[first]));
+    single = level(var(c[second])) < highest;
+
+    if(first != 0 || second != 1) {
+        if(c.size() > 2) detachClause(cr, true);
+        Lit tmp = c[0];
+        c[0] = c[first], c[first] = tmp;
+        if(second == 0) second = first;
+        tmp = c[1];
+        c[1] = c[second], c[second] = tmp;
+        if(c.size() > 2) attachClause(cr);
+    }
+    return highest;
+}
+
+
 /*_________________________________________________________________________________________________
 |
 |  analyzeFinal : (p : Lit)  ->  [void]
@@ -1139,9 +1486,14 @@ bool Solver::enqueue(Lit p, Constraint* from) {
 
 
 void Solver::uncheckedEnqueue(Lit p, CRef from) {
+    uncheckedEnqueue(p, decisionLevel(), from);
+}
+
+
+void Solver::uncheckedEnqueue(Lit p, int level, CRef from) {
     assert(value(p) == l_Undef);
     assigns[var(p)] = lbool(!sign(p));
-    vardata[var(p)] = mkVarData(from, decisionLevel());
+    vardata[var(p)] = mkVarData(from, level);
     trail.push_(p);
 
     addNumPendingPropagation(p, 1);
@@ -1174,12 +1526,14 @@ std::pair<CRef, Constraint*> Solver::propagate() {
     unaryWatches.cleanAll();
     while(qhead < trail.size()) {
         Lit p = trail[qhead++]; // 'p' is enqueued fact to propagate.
+        int currLevel = level(var(p));
         vec <Watcher> &ws = watches[p];
         Watcher *i, *j, *end;
         bool skip_constr = false;
         num_props++;
 
-
+        if(saved_head < saved_trail.size())
+            replaySavedTrail();
         // First, Propagate binary clauses
         vec <Watcher> &wbin = watchesBin[p];
         for(int k = 0; k < wbin.size(); k++) {
@@ -1192,11 +1546,13 @@ std::pair<CRef, Constraint*> Solver::propagate() {
                     Lit q = trail[qhead++];
                     addNumPendingPropagation(q, -1);
                 }
+                if(lrat && certifiedUNSAT && decisionLevel() == 0)
+                    lratUnits(wbin[k].cref);
                 return {wbin[k].cref, nullptr};
             }
 
             if(value(imp) == l_Undef) {
-                uncheckedEnqueue(imp, wbin[k].cref);
+                uncheckedEnqueue(imp, currLevel, wbin[k].cref);
             }
         }
 
@@ -1277,10 +1633,25 @@ std::pair<CRef, Constraint*> Solver::propagate() {
                 // Copy the remaining watches:
                 while(i < end)
                     *j++ = *i++;
+            } else if(currLevel == decisionLevel()) {
+                uncheckedEnqueue(first, currLevel, cr);
             } else {
-                uncheckedEnqueue(first, cr);
-
-
+                // Out of order propagation (chronological backtracking): 'first' is implied at the
+                // highest level among the false literals, which must become the second watch.
+                int maxLevel = currLevel;
+                int maxIndex = 1;
+                for(int k = 2; k < c.size(); k++)
+                    if(level(var(c[k])) > maxLevel) {
+                        maxLevel = level(var(c[k]));
+                        maxIndex = k;
+                    }
+                if(maxIndex != 1) {
+                    c[1] = c[maxIndex];
+                    c[maxIndex] = false_lit;
+                    j--;
+                    watches[~c[1]].push(w);
+                }
+                uncheckedEnqueue(first, maxLevel, cr);
             }
             NextClause:;
         }
@@ -1288,10 +1659,14 @@ std::pair<CRef, Constraint*> Solver::propagate() {
 
         if (skip_constr) break;
         vec<Constraint*>& ncws = constr_watches[toInt(p)];
+        bool explain = certifiedUNSAT && (decisionLevel() == 0 || explain_propagations);
         for (int k = 0; k < ncws.size(); ++k) {
             enqueue_failure = lit_Undef;
             ncws[k]->num_pending_propagation_ -= 1;
-            if (!ncws[k]->propagate(*this, p)) {
+            int from = trail.size();
+            bool ok_constr = ncws[k]->propagate(*this, p);
+            if (explain) explainPropagations(ncws[k], from, !ok_constr);
+            if (!ok_constr) {
                 for (int l = k + 1; l < ncws.size(); ++l) {
                     ncws[l]->num_pending_propagation_ -= 1;
                 }
@@ -1316,10 +1691,54 @@ std::pair<CRef, Constraint*> Solver::propagate() {
     propagations += num_props;
     simpDB_props -= num_props;
 
+    if(lrat && certifiedUNSAT && decisionLevel() == 0)
+        lratUnits(confl);
+
     return {confl, constr};
 }
 
 
+/*_________________________________________________________________________________________________
+|
+|  replaySavedTrail : [void]  ->  [void]
+|  
+|  Description:
+|    Called for each propagated literal. Once the next saved literal is true again, the following
+|    saved literals that were implied by clauses are enqueued with the same reasons, as long as these
+|    clauses are still unit at the current decision level. This skips the search for their
+|    implications; they are then propagated as usual (watches and constraints), since the watch
+|    lists and the constraints may have changed since the backtrack.
+|________________________________________________________________________________________________@*/
+void Solver::replaySavedTrail() {
+    lbool first = value(saved_trail[saved_head]);
+    if(first != l_True) {
+        if(first == l_False)
+            clearSavedTrail();
+        return;
+    }
+
+    for(saved_head++; saved_head < saved_trail.size(); saved_head++) {
+        Lit q = saved_trail[saved_head];
+        if(value(q) == l_True)
+            continue;
+        CRef cr = saved_reasons[saved_head];
+        if(value(q) == l_False || cr == CRef_Undef)
+            return;
+
+        // The reason must still be unit, with 'q' watched first and the second watch at the current
+        // level (otherwise a later backtrack could break the watch invariant):
+        const Clause &c = ca[cr];
+        if(c[0] != q || level(var(c[1])) != decisionLevel())
+            return;
+        for(int k = 1; k < c.size(); k++)
+            if(value(c[k]) != l_False) return;
+
+        uncheckedEnqueue(q, cr);
+        stats[nbTrailReplayed]++;
+    }
+}
+
+
 void Solver::addNumPendingPropagation(Lit p, int inc) {
     vec<Constraint*>& ncws = constr_watches[toInt(p)];
     for (int i = 0; i < ncws.size(); ++i) {
@@ -1478,6 +1897,10 @@ void Solver::removeSatisfied(vec <CRef> &cs) {
 
 
 void Solver::rebuildOrderHeap() {
+    if(vmtf) {
+        vmtf_search = vmtf_last;
+        return;
+    }
     vec <Var> vs;
     for(Var v = 0; v < nVars(); v++)
         if(decision[v] && value(v) == l_Undef)
@@ -1487,6 +1910,683 @@ void Solver::rebuildOrderHeap() {
 }
 
 
+/*_________________________________________________________________________________________________
+|
+|  vivifyLearnts : [void]  ->  [bool]
+|  
+|  Description:
+|    Vivification of the learnt clauses with a small LBD that were not vivified yet, at level 0.
+|    The negations of the literals of a clause are propagated one by one: literals found false are
+|    removed, and the clause is cut after a literal found true or when a conflict arises. Clauses
+|    are taken by increasing LBD until 'vivify_eff' times the search propagations since the last
+|    pass are spent. Returns FALSE if the formula was found unsatisfiable.
+|________________________________________________________________________________________________@*/
+bool Solver::vivifyLearnts() {
+    assert(decisionLevel() == 0);
+    if(hasConflict(propagate()))
+        return ok = false;
+
+    uint64_t limit = propagations + (uint64_t) ((propagations - vivify_props) * vivify_eff);
+
+    vivify_cands.clear();
+    for(int i = 0; i < learnts.size(); i++) {
+        Clause &c = ca[learnts[i]];
+        if(!c.getVivified() && !c.getOneWatched() && c.size() > 2 && c.lbd() <= (unsigned int) vivify_lbd)
+            vivify_cands.push(learnts[i]);
+    }
+    for(int i = 0; i < permanentLearnts.size(); i++) {
+        Clause &c = ca[permanentLearnts[i]];
+        if(!c.getVivified() && c.size() > 2)
+            vivify_cands.push(permanentLearnts[i]);
+    }
+    sort(vivify_cands, VivifyLt(ca));
+
+    bool removed = false;
+    for(int i = 0; i < vivify_cands.size() && propagations < limit; i++) {
+        CRef cr = vivify_cands[i];
+        if(!vivifyClause(cr))
+            return ok = false;
+        removed |= ca[cr].mark() == 1;
+    }
+
+    if(removed) {
+        vec<CRef> *sets[] = {&learnts, &permanentLearnts};
+        for(vec<CRef> *cs : sets) {
+            int j = 0;
+            for(int i = 0; i < cs->size(); i++)
+                if(ca[(*cs)[i]].mark() != 1)
+                    (*cs)[j++] = (*cs)[i];
+            cs->shrink(cs->size() - j);
+        }
+    }
+    vivify_props = propagations;
+    checkGarbage();
+    return true;
+}
+
+
+bool Solver::vivifyClause(CRef cr) {
+    Clause &c = ca[cr];
+    c.setVivified(true);
+    if(satisfied(c)) {
+        removeClause(cr);
+        return true;
+    }
+
+    // The clause must not propagate its own literals (nor be the saved reason of a replayed one)
+    detachClause(cr, true);
+    clearSavedTrail();
+    newDecisionLevel();
+    explain_propagations = true;
+    vivify_lits.clear();
+    for(int i = 0; i < c.size(); i++) {
+        Lit l = c[i];
+        if(value(l) == l_False) continue;
+        vivify_lits.push(l);
+        if(value(l) == l_True) break;
+        uncheckedEnqueue(~l);
+        if(hasConflict(propagate())) break;
+    }
+    explain_propagations = false;
+    cancelUntil(0);
+
+    if(vivify_lits.size() == c.size()) {
+        attachClause(cr);
+        return true;
+    }
+
+    stats[nbVivifiedClauses]++;
+    stats[nbVivifiedLits] += c.size() - vivify_lits.size();
+    writeProofClause(vivify_lits);
+
+    if(vivify_lits.size() <= 1) {
+        attachClause(cr);
+        removeClause(cr);
+        if(vivify_lits.size() == 0)
+            return false;
+        uncheckedEnqueue(vivify_lits[0]);
+        return !hasConflict(propagate());
+    }
+
+    writeProofClause(c, true);
+    for(int i = 0; i < vivify_lits.size(); i++)
+        c[i] = vivify_lits[i];
+    c.shrink(c.size() - vivify_lits.size());
+    if(c.lbd() > (unsigned int) c.size())
+        c.setLBD(c.size());
+    attachClause(cr);
+    return true;
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  probe : [void]  ->  [bool]
+|  
+|  Description:
+|    Failed literal probing at level 0, on the variables having a literal that is a root of the
+|    binary implication graph (it implies other literals, but no literal implies it). Both phases
+|    are propagated through clauses and constraints: a failed phase gives a unit, and so does a
+|    literal implied by both phases. A literal 'q' implied by a long clause with several false
+|    literals while probing a root gives the hyper-binary resolvent (~d v q), where 'd' is the
+|    closest dominator of those literals in the implication tree of the probe. At most
+|    'probe_hbr_max' resolvents are added per pass, as learnt clauses. A pass resumes where the
+|    previous one stopped and spends 'probe_min' plus 'probe_eff' times the search propagations
+|    since the last pass.
+|    Returns FALSE if the formula was found unsatisfiable.
+|________________________________________________________________________________________________@*/
+bool Solver::probe() {
+    assert(decisionLevel() == 0);
+    if(hasConflict(propagate()))
+        return ok = false;
+
+    uint64_t limit = propagations + probe_min + (uint64_t) ((propagations - probe_props) * probe_eff);
+    int hbr_budget = probe_hbr_max;
+    watchesBin.cleanAll();
+
+    int k;
+    for(k = 0; k < nVars() && propagations < limit; k++) {
+        Var v = (probe_next + k) % nVars();
+        if(value(v) != l_Undef || !decision[v]) continue;
+        Lit p = mkLit(v);
+        if(watchesBin[p].size() == 0 || watchesBin[~p].size() > 0) {
+            p = ~p;
+            if(watchesBin[p].size() == 0 || watchesBin[~p].size() > 0) continue;
+        }
+        stats[nbProbes]++;
+
+        // First phase: the root
+        if(!probeLit(p)) {
+            cancelUntil(0);
+            if(!probeUnit(~p)) return ok = false;
+            continue;
+        }
+        vec<Lit> first;
+        probe_lits.copyTo(first);
+        for(int i = 0; i < first.size(); i++)
+            seen[var(first[i])] = 1 + sign(first[i]);
+        cancelUntil(0);
+
+        // Hyper-binary resolvents:
+        for(int i = 0; i < probe_hbr.size() && hbr_budget > 0; i += 2, hbr_budget--) {
+            vec<Lit> bin(2);
+            bin[0] = ~probe_hbr[i];
+            bin[1] = probe_hbr[i + 1];
+            writeProofClause(bin);
+            CRef cr = ca.alloc(bin, true);
+            ca[cr].setLBD(2);
+            learnts.push(cr);
+            attachClause(cr);
+            stats[nbHyperBinaries]++;
+        }
+
+        // Second phase: literals implied by both phases are units
+        bool failed = !probeLit(~p);
+        vec<Lit> common;
+        if(!failed) {
+            for(int i = 0; i < probe_lits.size(); i++) {
+                Lit q = probe_lits[i];
+                if(seen[var(q)] == 1 + sign(q))
+                    common.push(q);
+            }
+        }
+        for(int i = 0; i < first.size(); i++)
+            seen[var(first[i])] = 0;
+        cancelUntil(0);
+
+        if(failed) {
+            if(!probeUnit(p)) return ok = false;
+            continue;
+        }
+        for(int i = 0; i < common.size(); i++)
+            if(value(common[i]) == l_Undef && !probeUnit(common[i], p))
+                return ok = false;
+    }
+    probe_next = nVars() > 0 ? (probe_next + k) % nVars() : 0;
+
+    probe_props = propagations;
+    checkGarbage();
+    return true;
+}
+
+
+bool Solver::probeLit(Lit p) {
+    assert(decisionLevel() == 0);
+    newDecisionLevel();
+    uncheckedEnqueue(p);
+    probe_lits.clear();
+    probe_hbr.clear();
+    explain_propagations = true;
+    bool conflict = hasConflict(propagate());
+    explain_propagations = false;
+    if(conflict)
+        return false;
+
+    // Implication tree of the probe: the parent of a literal is the closest literal through which
+    // all its implications from 'p' pass (or 'p' itself for the literals implied by constraints).
+    probe_dom.growTo(nVars());
+    probe_pos.growTo(nVars());
+    probe_dom[var(p)] = p;
+    probe_pos[var(p)] = trail_lim[0];
+    for(int i = trail_lim[0] + 1; i < trail.size(); i++) {
+        Lit q = trail[i];
+        if(level(var(q)) == 0) continue;
+        probe_lits.push(q);
+        probe_pos[var(q)] = i;
+        CRef cr = reason(var(q));
+        Lit d = cr == CRef_Undef ? p : lit_Undef;
+        int antecedents = 0;
+        if(cr != CRef_Undef) {
+            const Clause& c = ca[cr];
+            for(int k = 0; k < c.size(); k++) {
+                if(c[k] == q || level(var(c[k])) == 0) continue;
+                d = d == lit_Undef ? ~c[k] : probeDominator(d, ~c[k]);
+                antecedents++;
+            }
+        }
+        probe_dom[var(q)] = d;
+        if(antecedents > 1) {
+            probe_hbr.push(d);
+            probe_hbr.push(q);
+        }
+    }
+    return true;
+}
+
+
+Lit Solver::probeDominator(Lit p, Lit q) const {
+    while(p != q) {
+        if(probe_pos[var(p)] > probe_pos[var(q)])
+            p = probe_dom[var(p)];
+        else
+            q = probe_dom[var(q)];
+    }
+    return p;
+}
+
+
+bool Solver::probeUnit(Lit p, Lit q) {
+    assert(decisionLevel() == 0);
+    stats[nbProbeUnits]++;
+    vec<Lit> unit(1, p);
+    if(q != lit_Undef) {
+        // 'p' follows from (q v p) and (~q v p), which are both implied by propagation
+        vec<Lit> bin(2);
+        bin[0] = q;
+        bin[1] = p;
+        writeProofClause(bin);
+        bin[0] = ~q;
+        writeProofClause(bin);
+        writeProofClause(unit);
+        writeProofClause(bin, true);
+        bin[0] = q;
+        writeProofClause(bin, true);
+    } else
+        writeProofClause(unit);
+
+    uncheckedEnqueue(p);
+    return !hasConflict(propagate());
+}
+
+
+ProofWriter& Solver::proofWriter() {
+    if(!proof)
+        proof.reset(new ProofWriter(certifiedOutput, vbyte));
+    return *proof;
+}
+
+
+// The explanations of constraints are written to the proof as the lemmas (p v ~reason), or
+// (~reason) for a conflict. Those used by 'analyze()' are queued, written before the learnt clause
+// and deleted after it. Propagations that are not analyzed afterwards, at level 0 or while probing
+// and vivifying, are explained as they happen by 'explainPropagations()'.
+
+void Solver::explainToProof(Constraint* constr, Lit p, const vec<Lit>& reason) {
+    constr->certifyReason(*this, p, reason);
+    if(p != lit_Undef)
+        proof_explanations.push(p);
+    for(int i = 0; i < reason.size(); i++)
+        proof_explanations.push(~reason[i]);
+    proof_explanations.push(lit_Undef);
+}
+
+
+void Solver::writeExplanations(bool deletion) {
+    ProofWriter& w = proofWriter();
+    bool begin = true;
+    for(int i = 0; i < proof_explanations.size(); i++) {
+        Lit q = proof_explanations[i];
+        if(begin)
+            w.beginClause(deletion), begin = false;
+        if(q != lit_Undef)
+            w.addLit(q);
+        else
+            w.endClause(), begin = true;
+    }
+}
+
+
+void Solver::explainPropagations(Constraint* constr, int from, bool conflict) {
+    vec<Lit> reason;
+    for(int i = from; i < trail.size(); i++)
+        if(nc_reason(var(trail[i])) == constr) {
+            reason.clear();
+            constr->calcReason(*this, trail[i], lit_Undef, reason);
+            explainToProof(constr, trail[i], reason);
+        }
+    if(conflict) {
+        reason.clear();
+        constr->calcReason(*this, lit_Undef, enqueue_failure, reason);
+        explainToProof(constr, lit_Undef, reason);
+    }
+    writeExplanations(false);
+    proof_explanations.clear();
+}
+
+
+void Solver::useLRAT() {
+    assert(nClauses() == 0 && constraints.empty());
+    lrat = true;
+    ca.clause_ids = true;
+    vivify = false;
+    probing = false;
+    chrono = -1;
+}
+
+
+// LRAT proofs. A lemma lists the IDs of the clauses that become unit, and finally false, when its
+// literals are false. The literals assigned at level 0 get their own unit clauses, so that the
+// clauses implying them can be deleted. The IDs of the lemmas must follow those of all the input
+// clauses: until the search starts, lemmas are queued with temporary IDs ('queued_id' plus their
+// index in the queue), renumbered by 'lratEndInput()'.
+
+static const uint64_t queued_id = (uint64_t)1 << 63;
+
+uint64_t Solver::writeLemma(const vec<Lit>& lits, const vec<uint64_t>& hints) {
+    if(lrat_input) {
+        lrat_queue.push(0);
+        lrat_queue.push(lits.size());
+        for(int i = 0; i < lits.size(); i++)
+            lrat_queue.push(toInt(lits[i]));
+        lrat_queue.push(hints.size());
+        for(int i = 0; i < hints.size(); i++)
+            lrat_queue.push(hints[i]);
+        return queued_id | lrat_n_queued++;
+    }
+    ProofWriter& w = proofWriter();
+    w.beginLemma(++proof_id);
+    for(int i = 0; i < lits.size(); i++)
+        w.addLit(lits[i]);
+    w.beginHints();
+    for(int i = 0; i < hints.size(); i++)
+        w.addId(hints[i]);
+    w.endClause();
+    return proof_id;
+}
+
+
+void Solver::lratDelete(uint64_t id) {
+    if(lrat_input) {
+        lrat_queue.push(1);
+        lrat_queue.push(1);
+        lrat_queue.push(id);
+        return;
+    }
+    ProofWriter& w = proofWriter();
+    w.beginDeletion(proof_id);
+    w.addId(id);
+    w.endClause();
+}
+
+
+void Solver::deleteFromProof(CRef cr) {
+    if(!certifiedUNSAT) return;
+    Clause &c = ca[cr];
+    if(!lrat)
+        writeProofClause(c, true);
+    else if(c.hasId())
+        lratDelete(c.id());
+}
+
+
+void Solver::lratEndInput() {
+    lrat_input = false;
+    if(!lrat || !certifiedUNSAT) return;
+
+    // 'proof_id' is the number of input clauses:
+    uint64_t base = proof_id + 1;
+    auto final_id = [base](uint64_t id) { return id & queued_id ? base + (id & ~queued_id) : id; };
+    ProofWriter& w = proofWriter();
+    for(int i = 0; i < lrat_queue.size();) {
+        if(lrat_queue[i++] == 0) {
+            w.beginLemma(++proof_id);
+            for(uint64_t n = lrat_queue[i++]; n > 0; n--)
+                w.addLit(toLit(lrat_queue[i++]));
+            w.beginHints();
+        } else
+            w.beginDeletion(proof_id);
+        for(uint64_t n = lrat_queue[i++]; n > 0; n--)
+            w.addId(final_id(lrat_queue[i++]));
+        w.endClause();
+    }
+    lrat_queue.clear(true);
+
+    for(int i = 0; i < clauses.size(); i++)
+        if(ca[clauses[i]].hasId())
+            ca[clauses[i]].setId(final_id(ca[clauses[i]].id()));
+    for(int i = 0; i < unit_ids.size(); i++)
+        unit_ids[i] = final_id(unit_ids[i]);
+}
+
+
+void Solver::setUnitId(Var v, uint64_t id) {
+    if(unit_ids.size() < nVars())
+        unit_ids.growTo(nVars(), 0);
+    unit_ids[v] = id;
+}
+
+
+void Solver::lratUnits(CRef confl) {
+    if(unit_ids.size() < nVars())
+        unit_ids.growTo(nVars(), 0);
+    vec<Lit> unit(1);
+    for(; lrat_trail < trail.size(); lrat_trail++) {
+        Var v = var(trail[lrat_trail]);
+        if(unit_ids[v] != 0) continue;
+        assert(reason(v) != CRef_Undef);
+        const Clause &c = ca[reason(v)];
+        lrat_hints.clear();
+        for(int i = 0; i < c.size(); i++)
+            if(var(c[i]) != v)
+                lrat_hints.push(unit_ids[var(c[i])]);
+        lrat_hints.push(c.id());
+        unit[0] = trail[lrat_trail];
+        unit_ids[v] = writeLemma(unit, lrat_hints);
+    }
+
+    if(confl != CRef_Undef && !lrat_empty) {
+        const Clause &c = ca[confl];
+        lrat_hints.clear();
+        for(int i = 0; i < c.size(); i++)
+            lrat_hints.push(unit_ids[var(c[i])]);
+        lrat_hints.push(c.id());
+        writeLemma(vec<Lit>(), lrat_hints);
+        lrat_empty = true;
+    }
+}
+
+
+// The hints of a learnt clause are the reasons of the literals between the conflict and the
+// learnt clause, each after the reasons of the literals it depends on, and the conflicting clause.
+// The literals removed by binary clauses in 'minimisationWithBinaryResolution()' only depend on
+// the asserting literal. The unit clauses of the literals at level 0 come first.
+
+void Solver::lratChain(CRef confl, const vec<Lit>& learnt) {
+    if(lrat_seen.size() < nVars())
+        lrat_seen.growTo(nVars(), 0);
+    lrat_hints.clear();
+    lrat_toclear.clear();
+    for(int i = 0; i < learnt.size(); i++) {
+        lrat_seen[var(learnt[i])] = 1;
+        lrat_toclear.push(var(learnt[i]));
+    }
+
+    vec<uint64_t> chain;
+    for(int i = 0; i < lrat_bin.size(); i++) {
+        const Clause &c = ca[lrat_bin[i]];
+        Var v = var(c[0] == learnt[0] ? c[1] : c[0]);
+        lrat_seen[v] = 1;
+        lrat_toclear.push(v);
+        chain.push(c.id());
+    }
+    lrat_bin.clear();
+
+    lrat_stack.clear();
+    lrat_stack.push(std::make_pair(confl, 0));
+    while(lrat_stack.size() > 0) {
+        const Clause &c = ca[lrat_stack.last().first];
+        if(lrat_stack.last().second == c.size()) {
+            chain.push(c.id());
+            lrat_stack.pop();
+            continue;
+        }
+        Lit q = c[lrat_stack.last().second++];
+        Var v = var(q);
+        if(value(q) != l_False || lrat_seen[v]) continue;  // (the literal implied by a reason is true)
+        lrat_seen[v] = 1;
+        lrat_toclear.push(v);
+        if(level(v) == 0)
+            lrat_hints.push(unit_ids[v]);
+        else {
+            assert(reason(v) != CRef_Undef);
+            lrat_stack.push(std::make_pair(reason(v), 0));
+        }
+    }
+    for(int i = 0; i < chain.size(); i++)
+        lrat_hints.push(chain[i]);
+
+    for(int i = 0; i < lrat_toclear.size(); i++)
+        lrat_seen[lrat_toclear[i]] = 0;
+}
+
+
+void Solver::closeProof(bool unsat) {
+    if(certifiedOutput == NULL) return; // Already closed
+    if(lrat_input)
+        lratEndInput();
+    if(unsat && !lrat)
+        writeProofClause(vec<Lit>());
+    proof.reset();
+    fclose(certifiedOutput);
+    certifiedOutput = NULL;
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  switchMode : [void]  ->  [void]
+|  
+|  Description:
+|    Alternate between focused mode (glucose dynamic restarts) and stable mode (Luby restarts,
+|    decisions following the target phases). A focused mode and the following stable mode last
+|    'mode_length' conflicts each; the length grows by 'stable_inc' after every stable mode.
+|________________________________________________________________________________________________@*/
+void Solver::switchMode() {
+    stable = !stable;
+    stats[nbModeSwitches]++;
+    if(!stable)
+        mode_length *= stable_inc;
+    next_mode_switch = conflicts + (uint64_t) mode_length;
+
+    target_assigned = 0;
+    if(stable) {
+        next_rephase = conflicts + rephase_int;
+    } else {
+        // Back to the glucose restart strategy
+        lbdQueue.fastclear();
+        sumLBD = 0;
+        conflictsRestarts = 0;
+    }
+    if(verbosity >= 2)
+        printf("c switching to %s mode at %" PRIu64" conflicts\n", stable ? "stable" : "focused", conflicts);
+}
+
+
+void Solver::updateTargetPhases(int conflict_level) {
+    // Assignments below the conflict level are consistent
+    int assigned = trail_lim[conflict_level - 1];
+    if(assigned > target_assigned) {
+        for(int i = 0; i < assigned; i++)
+            target_polarity[var(trail[i])] = sign(trail[i]);
+        target_assigned = assigned;
+    }
+    if(assigned > best_assigned) {
+        for(int i = 0; i < assigned; i++)
+            best_polarity[var(trail[i])] = sign(trail[i]);
+        best_assigned = assigned;
+    }
+}
+
+
+void Solver::rephase() {
+    // Cycle: original, best, inverted, best, random, best
+    static const char schedule[] = {'O', 'B', 'I', 'B', 'R', 'B'};
+    char kind = schedule[rephase_count % 6];
+    for(Var v = 0; v < nVars(); v++) {
+        switch(kind) {
+            case 'O': polarity[v] = orig_polarity[v]; break;
+            case 'I': polarity[v] = !orig_polarity[v]; break;
+            case 'B': if(best_polarity[v] != 2) polarity[v] = best_polarity[v]; break;
+            case 'R': polarity[v] = drand(random_seed) < 0.5; break;
+        }
+        target_polarity[v] = 2;
+    }
+    if(kind == 'B')
+        best_assigned = 0;
+    target_assigned = 0;
+    rephase_count++;
+    stats[nbRephases]++;
+    next_rephase = conflicts + (uint64_t) rephase_int * (rephase_count + 1);
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  VMTF queue : Variable Move-To-Front decision heuristic
+|  
+|  Description:
+|    Variables bumped in a conflict are moved to the front of a doubly linked queue (keeping their
+|    relative order) and decisions pick the unassigned variable closest to the front. 'vmtf_search'
+|    caches the position of the last decision; it only moves forward again when a variable more
+|    recent than it is unassigned ('insertVarOrder()') or bumped.
+|________________________________________________________________________________________________@*/
+void Solver::vmtfEnqueue(Var x) {
+    vmtf_links[x].prev = vmtf_last;
+    vmtf_links[x].next = var_Undef;
+    if(vmtf_last != var_Undef)
+        vmtf_links[vmtf_last].next = x;
+    else
+        vmtf_first = x;
+    vmtf_last = x;
+    vmtf_stamp[x] = ++vmtf_time;
+}
+
+
+void Solver::vmtfDequeue(Var x) {
+    VMTFLink &l = vmtf_links[x];
+    if(l.prev != var_Undef) vmtf_links[l.prev].next = l.next;
+    else vmtf_first = l.next;
+    if(l.next != var_Undef) vmtf_links[l.next].prev = l.prev;
+    else vmtf_last = l.prev;
+}
+
+
+void Solver::vmtfBumpQueue() {
+    sort(vmtf_bumped, VMTFStampLt(vmtf_stamp));
+    for(int i = 0; i < vmtf_bumped.size(); i++) {
+        Var x = vmtf_bumped[i];
+        if(i > 0 && vmtf_bumped[i - 1] == x) continue;
+        if(x == vmtf_search)
+            vmtf_search = vmtf_links[x].prev != var_Undef ? vmtf_links[x].prev : vmtf_links[x].next;
+        vmtfDequeue(x);
+        vmtfEnqueue(x);
+        if(vmtf_search == var_Undef || (value(x) == l_Undef && decision[x]))
+            vmtf_search = x;
+    }
+    vmtf_bumped.clear();
+}
+
+
+Var Solver::vmtfNextVar() {
+    Var x = vmtf_search;
+    while(x != var_Undef && (value(x) != l_Undef || !decision[x]))
+        x = vmtf_links[x].prev;
+    if(x != var_Undef)
+        vmtf_search = x;
+    return x;
+}
+
+
+void Solver::setVMTF(bool b) {
+    if(b == vmtf) return;
+    vmtf = b;
+    if(vmtf) {
+        // Start from the VSIDS order: the most active variable goes to the front
+        vec<Var> vs;
+        for(Var v = 0; v < nVars(); v++)
+            vs.push(v);
+        sort(vs, VarOrderLt(activity));
+        vmtf_first = vmtf_last = var_Undef;
+        for(int i = vs.size() - 1; i >= 0; i--)
+            vmtfEnqueue(vs[i]);
+        vmtf_search = vmtf_last;
+        vmtf_bumped.clear();
+        order_heap.clear();
+    } else
+        rebuildOrderHeap();
+}
+
+
 /*_________________________________________________________________________________________________
 |
 |  simplify : [void]  ->  [bool]
@@ -1497,6 +2597,8 @@ void Solver::rebuildOrderHeap() {
 |________________________________________________________________________________________________@*/
 bool Solver::simplify() {
     assert(decisionLevel() == 0);
+    if(lrat_input)
+        lratEndInput();
 
     if(!ok) return ok = false;
     else {
@@ -1515,6 +2617,8 @@ bool Solver::simplify() {
     removeSatisfied(unaryWatchedClauses);
     if(remove_satisfied) // Can be turned off.
         removeSatisfied(clauses);
+    for(auto& constr : constraints)
+        constr->simplify(*this);
     checkGarbage();
     rebuildOrderHeap();
 
@@ -1582,6 +2686,10 @@ void Solver::adaptSolver() {
         conflictsRestarts = 0;
     }
 
+    // Quickly changing decisions (fast variable decay) suit the VMTF queue, Luby restarts VSIDS
+    if(adapt_vmtf && adjusted)
+        setVMTF(!luby_restart);
+
     if(chanseokStrategy && adjusted) {
         int moved = 0;
         int i, j;
@@ -1689,6 +2797,32 @@ lbool Solver::search(int nof_conflicts) {
                 return l_Undef;
             }
 
+            // With chronological backtracking the conflict may lie below the current decision level
+            int conflictLevel = decisionLevel();
+            if(chrono >= 0) {
+                bool single;
+                conflictLevel = findConflictLevel(confl_pair, single);
+                if(conflictLevel == 0) {
+                    if(certifiedUNSAT && confl_pair.second != nullptr) {
+                        explainToProof(confl_pair.second, lit_Undef, conflict_reason);
+                        writeExplanations(false);
+                        proof_explanations.clear();
+                    }
+                    conflict_reason_valid = false;
+                    return l_False;
+                }
+                if(single) {
+                    // Missed lower implication: the clause is asserting one level below
+                    CRef cr = confl_pair.first;
+                    cancelUntil(conflictLevel - 1);
+                    uncheckedEnqueue(ca[cr][0], level(var(ca[cr][1])), cr);
+                    continue;
+                }
+            }
+
+            if(stable)
+                updateTargetPhases(conflictLevel);
+
             trailQueue.push(trail.size());
             // BLOCK RESTART (CP 2012 paper)
             if(conflictsRestarts > LOWER_BOUND_FOR_BLOCKING_RESTART && lbdQueue.isvalid() && trail.size() > R * trailQueue.getavg()) {
@@ -1704,42 +2838,50 @@ lbool Solver::search(int nof_conflicts) {
             learnt_clause.clear();
             selectors.clear();
 
-            analyze(confl_pair.first, confl_pair.second, learnt_clause, selectors, backtrack_level, nblevels, szWithoutSelectors);
+            analyze(confl_pair.first, confl_pair.second, conflictLevel, learnt_clause, selectors, backtrack_level, nblevels, szWithoutSelectors);
+            if(lrat && certifiedUNSAT)
+                lratChain(confl_pair.first, learnt_clause);
 
             lbdQueue.push(nblevels);
             sumLBD += nblevels;
 
-            cancelUntil(backtrack_level);
-
-            if(certifiedUNSAT) {
-                if(vbyte) {
-                    write_char('a');
-                    for(int i = 0; i < learnt_clause.size(); i++)
-                        write_lit(2 * (var(learnt_clause[i]) + 1) + sign(learnt_clause[i]));
-                    write_lit(0);
-                }
-                else {
-                    for(int i = 0; i < learnt_clause.size(); i++)
-                        fprintf(certifiedOutput, "%i ", (var(learnt_clause[i]) + 1) *
-                                                        (-2 * sign(learnt_clause[i]) + 1));
-                    fprintf(certifiedOutput, "0\n");
-                }
+            if(chrono >= 0 && (confl_to_chrono < 0 || conflicts >= (uint64_t) confl_to_chrono) &&
+               learnt_clause.size() > 1 && conflictLevel - backtrack_level >= chrono) {
+                stats[nbChronoBT]++;
+                cancelUntil(conflictLevel - 1);
+            } else {
+                if(chrono >= 0) stats[nbNonChronoBT]++;
+                cancelUntil(backtrack_level);
             }
 
+            uint64_t id = 0;
+            if(proof_explanations.size() > 0) {
+                // The explanations are only needed to check the learnt clause
+                writeExplanations(false);
+                writeProofClause(learnt_clause);
+                writeExplanations(true);
+                proof_explanations.clear();
+            } else if(lrat && certifiedUNSAT)
+                id = writeLemma(learnt_clause, lrat_hints);
+            else
+                writeProofClause(learnt_clause);
 
             if(learnt_clause.size() == 1) {
                 uncheckedEnqueue(learnt_clause[0]);
+                if(id != 0) setUnitId(var(learnt_clause[0]), id);
                 stats[nbUn]++;
                 parallelExportUnaryClause(learnt_clause[0]);
             } else {
                 CRef cr;
                 if(chanseokStrategy && nblevels <= coLBDBound) {
                     cr = ca.alloc(learnt_clause, false);
+                    if(id != 0) ca[cr].setId(id);
                     permanentLearnts.push(cr);
                     stats[nbPermanentLearnts]++;
                 } else {
                     cr = ca.alloc(learnt_clause, true);
                     ca[cr].setLBD(nblevels);
+                    if(id != 0) ca[cr].setId(id);
                     ca[cr].setOneWatched(false);
                     learnts.push(cr);
                     claBumpActivity(ca[cr]);
@@ -1752,7 +2894,7 @@ lbool Solver::search(int nof_conflicts) {
                 attachClause(cr);
                 lastLearntClause = cr; // Use in multithread (to hard to put inside ParallelSolver)
                 parallelExportClauseDuringSearch(ca[cr]);
-                uncheckedEnqueue(learnt_clause[0], cr);
+                uncheckedEnqueue(learnt_clause[0], backtrack_level, cr);
 
             }
             varDecayActivity();
@@ -1761,8 +2903,10 @@ lbool Solver::search(int nof_conflicts) {
 
         } else {
             // Our dynamic restart, see the SAT09 competition compagnion paper
-            if((luby_restart && nof_conflicts <= conflictC) ||
-               (!luby_restart && (lbdQueue.isvalid() && ((lbdQueue.getavg() * K) > (sumLBD / conflictsRestarts))))) {
+            bool lubyMode = luby_restart || stable;
+            if((lubyMode && nof_conflicts <= conflictC) ||
+               (!lubyMode && (lbdQueue.isvalid() && ((lbdQueue.getavg() * K) > (sumLBD / conflictsRestarts)))) ||
+               (stable_mode_switching && conflicts >= next_mode_switch)) {
                 lbdQueue.fastclear();
                 progress_estimate = progressEstimate();
                 int bt = 0;
@@ -1771,6 +2915,7 @@ lbool Solver::search(int nof_conflicts) {
                     bt = (decisionLevel()<assumptions.size()) ? decisionLevel() : assumptions.size();
 #endif
                 newDescent = true;
+                target_assigned = 0;
 
                 if(randomize_on_restarts || fixed_randomize_on_restarts) {
                     randomDescentAssignments = (uint32_t) drand(random_seed);
@@ -1917,9 +3062,14 @@ lbool Solver::solve_(bool do_simp, bool turn_off_simp) // Parameters are useless
         exit(-1);
     }
 
+    if(lrat_input)
+        lratEndInput();
     model.clear();
     conflict.clear();
-    if(!ok) return l_False;
+    if(!ok) {
+        if(certifiedUNSAT) closeProof(true);
+        return l_False;
+    }
     double curTime = cpuTime();
 
     solves++;
@@ -1964,28 +3114,46 @@ lbool Solver::solve_(bool do_simp, bool turn_off_simp) // Parameters are useless
     // Search:
     int curr_restarts = 0;
     while(status == l_Undef) {
-        status = search(
+        if(probing && decisionLevel() == 0 && conflicts >= next_probe) {
+            next_probe = conflicts + probe_int;
+            if(!probe()) {
+                status = l_False;
+                break;
+            }
+        }
+        if(stable_mode_switching) {
+            if(mode_length == 0) { // First focused mode
+                mode_length = stable_init;
+                next_mode_switch = conflicts + stable_init;
+            }
+            if(conflicts >= next_mode_switch)
+                switchMode();
+            if(stable && rephase_int > 0 && conflicts >= next_rephase)
+                rephase();
+        }
+        if(stable)
+            status = search(luby(restart_inc, stable_restarts++) * luby_restart_factor);
+        else
+            status = search(
                 luby_restart ? luby(restart_inc, curr_restarts) * luby_restart_factor : 0); // the parameter is useless in glucose, kept to allow modifications
 
         if(!withinBudget()) break;
-        curr_restarts++;
+        if(!stable) curr_restarts++;
+
+        if(vivify && status == l_Undef && decisionLevel() == 0 && conflicts >= next_vivify) {
+            next_vivify = conflicts + vivify_int;
+            if(!vivifyLearnts())
+                status = l_False;
+        }
+        if(status == l_Undef && decisionLevel() == 0 && !inprocess())
+            status = l_False;
     }
 
     if(!incremental && verbosity >= 1)
         printf("c =========================================================================================================\n");
 
-    if(certifiedUNSAT) { // Want certified output
-        if(status == l_False) {
-            if(vbyte) {
-                write_char('a');
-                write_lit(0);
-            }
-            else {
-                fprintf(certifiedOutput, "0\n");
-            }
-        }
-        fclose(certifiedOutput);
-    }
+    if(certifiedUNSAT) // Want certified output
+        closeProof(status == l_False);
 
 
     if(status == l_True) {
@@ -2098,6 +3266,9 @@ void Solver::toDimacs(FILE *f, const vec <Lit> &assumps) {
 // Garbage Collection methods:
 
 void Solver::relocAll(ClauseAllocator &to) {
+    // Saved reasons are not relocated; simply forget them.
+    clearSavedTrail();
+
     // All watchers:
     // for (int i = 0; i < watches.size(); i++)
     watches.cleanAll();
@@ -2149,6 +3320,7 @@ void Solver::garbageCollect() {
     // Initialize the next region to a size corresponding to the estimated utilization degree. This
     // is not precise but should avoid some unnecessary reallocations for the new region:
     ClauseAllocator to(ca.size() - ca.wasted());
+    to.clause_ids = ca.clause_ids;
     relocAll(to);
     if(verbosity >= 2)
         printf("|  Garbage collection:   %12d bytes => %12d bytes             |\n",
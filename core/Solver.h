@@ -51,9 +51,12 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define Glucose_Solver_h
 
 #include "mtl/Heap.h"
+#include "mtl/DaryHeap.h"
 #include "mtl/Alg.h"
 #include "utils/Options.h"
 #include "core/SolverTypes.h"
+#include "core/BinaryCNF.h"
+#include "core/ProofWriter.h"
 #include "core/BoundedQueue.h"
 #include "core/Constants.h"
 #include "mtl/Clone.h"
@@ -61,9 +64,19 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "core/Constraint.h"
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace Glucose {
+
+// Priority queue used for the decision heuristic (and variable elimination in 'SimpSolver'). The
+// 4-ary heap keeps the keys inline; define GLUCOSE_BINARY_HEAP to get back the binary 'Heap'.
+#ifdef GLUCOSE_BINARY_HEAP
+template<class Comp> using SolverHeap = Heap<Comp>;
+#else
+template<class Comp> using SolverHeap = DaryHeap<Comp, 4>;
+#endif
+
 // Core stats 
     
 enum CoreStats {
@@ -90,10 +103,20 @@ enum CoreStats {
   learnts_literals,
   max_literals,
   tot_literals,
-  noDecisionConflict
+  noDecisionConflict,
+  nbChronoBT,
+  nbNonChronoBT,
+  nbModeSwitches,
+  nbRephases,
+  nbVivifiedClauses,
+  nbVivifiedLits,
+  nbProbes,
+  nbProbeUnits,
+  nbHyperBinaries,
+  nbTrailReplayed
 } ;
 
-#define coreStatsSize 24
+#define coreStatsSize 34
 //=================================================================================================
 // Solver -- the main class:
 
@@ -121,6 +144,8 @@ public:
     //
     virtual Var     newVar    (bool polarity = true, bool dvar = true); // Add a new variable with parameters specifying variable mode.
     Var     newNamedVar (const std::string& name);              // Add a variable with name.
+    virtual void reserveVars(int n);                            // Reserve room for 'n' variables in total.
+    Var     newVars   (int n, bool polarity = true, bool dvar = true); // Add 'n' variables, returning the first one.
     bool    addClause (const vec<Lit>& ps);                     // Add a clause to the solver. 
     bool    addEmptyClause();                                   // Add the empty clause, making the solver contradictory.
     bool    addClause (Lit p);                                  // Add a unit clause to the solver. 
@@ -128,9 +153,14 @@ public:
     bool    addClause (Lit p, Lit q, Lit r);                    // Add a ternary clause to the solver. 
     virtual bool    addClause_(      vec<Lit>& ps);                     // Add a clause to the solver without making superflous internal copy. Will
                                                                 // change the passed vector 'ps'.
+    virtual bool addClauses(const Lit* lits, const uint32_t* offsets, int n_clauses); // Add the clauses 'lits[offsets[i]..offsets[i+1]-1]'
+                                                                // for i < 'n_clauses', in the same way as 'addClause_()'.
 
-    bool    addConstraint (std::unique_ptr<Constraint>&& constr);  // Add a non-clause constraint to the solver.
+    bool    addConstraint (std::unique_ptr<Constraint>&& constr, bool encoded = false); // Add a non-clause constraint to the solver. With
+                                                                // 'certifiedUNSAT', 'encoded' must tell that the checked formula
+                                                                // contains a clausal encoding of it (see 'Constraint::certifyReason()').
     void    addWatch (Lit p, Constraint* constr);   // Register 'constr' as an watcher of literal 'p'
+    void    removeWatch(Lit p, Constraint* constr); // Unregister 'constr' as a watcher of literal 'p' (at level 0)
     // Solving:
     //
     bool    simplify     ();                        // Removes already satisfied clauses.
@@ -153,6 +183,10 @@ public:
     void    toDimacs     (const char* file, Lit p);
     void    toDimacs     (const char* file, Lit p, Lit q);
     void    toDimacs     (const char* file, Lit p, Lit q, Lit r);
+
+    // Binary CNF files (see 'core/BinaryCNF.h'):
+    void    toBinary     (const char* file, const std::vector<BinaryConstraint>& constrs = std::vector<BinaryConstraint>());
+    bool    loadBinary   (const BinaryCNF& cnf);    // Insert the problem of a binary CNF file.
  
     // Display clauses and literals
     void printLit(Lit l);
@@ -163,6 +197,7 @@ public:
     // 
     void    setPolarity    (Var v, bool b); // Declare which polarity the decision heuristic should use for a variable. Requires mode 'polarity_user'.
     void    setDecisionVar (Var v, bool b); // Declare if a variable should be eligible for selection in the decision heuristic.
+    void    setVMTF        (bool b);        // Switch between the VMTF queue (true) and the VSIDS heap (false) for decisions.
 
     // Read state:
     //
@@ -239,6 +274,24 @@ public:
     bool      rnd_init_act;       // Initialize variable activities with a small random value.
     bool      randomizeFirstDescent; // the first decisions (until first cnflict) are made randomly
                                      // Useful for syrup!
+    int       chrono;             // Backtrack chronologically when the jump is at least this many levels (-1 = never).
+    int       confl_to_chrono;    // Number of conflicts before chronological backtracking may be used (-1 = immediately).
+    bool      trail_saving;       // Replay the clause implications of the trail removed by the last backtrack.
+    bool      vmtf;               // Pick decisions from the VMTF queue instead of the VSIDS heap (change it with 'setVMTF()').
+    bool      adapt_vmtf;         // Let 'adaptSolver()' choose between VMTF and VSIDS.
+    bool      stable_mode_switching; // Alternate focused (glucose restarts) and stable (Luby restarts, target phases) modes.
+    int       stable_init;        // Number of conflicts of the first focused mode.
+    double    stable_inc;         // Growth factor of the mode lengths after each stable mode.
+    int       rephase_int;        // Base number of conflicts between rephasings in stable mode (0 = never).
+    bool      vivify;             // Periodically vivify learnt clauses of small LBD.
+    int       vivify_lbd;         // Only learnt clauses with an LBD up to this value are vivified.
+    double    vivify_eff;         // Propagations allowed for vivification, relative to search propagations.
+    int       vivify_int;         // Number of conflicts between two vivification passes.
+    bool      probing;            // Probe roots of the binary implication graph at level 0.
+    int       probe_int;          // Number of conflicts between two probing passes.
+    double    probe_eff;          // Propagations allowed for probing, relative to search propagations.
+    int       probe_min;          // Propagations always allowed for a probing pass.
+    int       probe_hbr_max;      // Hyper-binary resolvents added per probing pass.
     
     // Constant for Memory managment
     double    garbage_frac;       // The fraction of wasted memory allowed before a garbage collection is triggered.
@@ -246,13 +299,18 @@ public:
     // Certified UNSAT ( Thanks to Marijn Heule
     // New in 2016 : proof in DRAT format, possibility to use binary output
     FILE*               certifiedOutput;
+    std::unique_ptr<ProofWriter> proof;  // Buffered writer to 'certifiedOutput'
     bool                certifiedUNSAT;
     bool                vbyte;
+    bool                lrat;             // The proof is in LRAT format: clauses have IDs, and lemmas the IDs of their antecedents
 
     bool                dump_analysis_info;
 
-    void write_char (unsigned char c);
-    void write_lit (int n);
+    virtual void useLRAT (); // Write the proof in LRAT format (before adding clauses). Disables the techniques without LRAT hints.
+    void closeProof (bool unsat);  // Finish the proof, with the empty clause if 'unsat', and close the file
+    template<class Lits>
+    void writeProofClause (const Lits& lits, bool deletion = false, Lit skip = lit_Undef); // Log a lemma or a deletion (without 'skip')
+    ProofWriter& proofWriter ();
 
     // Misc:
     //
@@ -327,11 +385,31 @@ protected:
     };
 
     struct VarOrderLt {
+        typedef double Key;
         const vec<double>&  activity;
         bool operator () (Var x, Var y) const { return activity[x] > activity[y]; }
+        Key  key  (Var x)        const { return activity[x]; }
+        bool keyLt(Key a, Key b) const { return a > b; }
         VarOrderLt(const vec<double>&  act) : activity(act) { }
     };
 
+    struct VMTFLink { Var prev, next; };
+
+    struct VivifyLt {
+        ClauseAllocator& ca;
+        VivifyLt(ClauseAllocator& ca_) : ca(ca_) {}
+        bool operator () (CRef x, CRef y) {
+            if (ca[x].lbd() != ca[y].lbd()) return ca[x].lbd() < ca[y].lbd();
+            return ca[x].size() < ca[y].size();
+        }
+    };
+
+    struct VMTFStampLt {
+        const vec<uint64_t>& stamp;
+        bool operator () (Var x, Var y) const { return stamp[x] < stamp[y]; }
+        VMTFStampLt(const vec<uint64_t>& s) : stamp(s) { }
+    };
+
 
     // Solver state:
     //
@@ -370,7 +448,43 @@ protected:
     int                 simpDB_assigns;   // Number of top-level assignments since last execution of 'simplify()'.
     int64_t             simpDB_props;     // Remaining number of propagations that must be made before next execution of 'simplify()'.
     vec<Lit>            assumptions;      // Current set of assumptions provided to solve by the user.
-    Heap<VarOrderLt>    order_heap;       // A priority queue of variables ordered with respect to the variable activity.
+    SolverHeap<VarOrderLt> order_heap;       // A priority queue of variables ordered with respect to the variable activity.
+
+    // VMTF queue: all variables in a doubly linked list, the most recently bumped one being 'vmtf_last'.
+    // Every variable after 'vmtf_search' is assigned (or not a decision variable).
+    vec<VMTFLink>       vmtf_links;
+    vec<uint64_t>       vmtf_stamp;       // Time at which each variable was moved to the front
+    uint64_t            vmtf_time;
+    Var                 vmtf_first, vmtf_last;
+    Var                 vmtf_search;
+    vec<Var>            vmtf_bumped;      // Variables bumped during the current conflict analysis
+
+    // Stable/focused mode switching:
+    bool                stable;           // Currently in stable mode
+    uint64_t            next_mode_switch; // Conflicts at which the mode is switched
+    double              mode_length;      // Length (in conflicts) of the current pair of modes
+    uint64_t            next_rephase;
+    int                 rephase_count;
+    int                 stable_restarts;  // Index in the Luby sequence of stable mode
+    vec<char>           orig_polarity;    // Polarity given by the user ('newVar()' or 'setPolarity()')
+    vec<char>           target_polarity;  // Phases of the largest conflict free trail since the last restart (2 = none)
+    vec<char>           best_polarity;    // Phases of the largest conflict free trail since the last rephasing (2 = none)
+    int                 target_assigned, best_assigned;
+
+    // Vivification:
+    uint64_t            next_vivify;      // Conflicts at which the next vivification may start
+    uint64_t            vivify_props;     // Value of 'propagations' at the end of the last vivification
+    vec<CRef>           vivify_cands;
+    vec<Lit>            vivify_lits;
+
+    // Probing:
+    uint64_t            next_probe;       // Conflicts at which the next probing pass may start
+    uint64_t            probe_props;      // Value of 'propagations' at the end of the last probing pass
+    Var                 probe_next;       // Variable where the next probing pass starts
+    vec<Lit>            probe_lits;       // Literals implied by the probe
+    vec<Lit>            probe_hbr;        // Hyper-binary resolvents (~d v q) found by the probe, as pairs (d, q)
+    vec<Lit>            probe_dom;        // 'probe_dom[var]' is the dominator of a literal implied by the probe
+    vec<int>            probe_pos;        // 'probe_pos[var]' is the trail position of a literal implied by the probe
     double              progress_estimate;// Set by 'search()'.
     bool                remove_satisfied; // Indicates whether possibly inefficient linear scan for satisfied clauses should be performed in 'simplify'.
     vec<unsigned int>   permDiff;           // permDiff[var] contains the current conflict number... Used to count the number of  LBD
@@ -398,6 +512,34 @@ protected:
     vec<Lit>            analyze_stack;
     vec<Lit>            analyze_toclear;
     vec<Lit>            add_tmp;
+    vec<Lit>            cancel_kept;
+    vec<Lit>            conflict_reason;      // Explanation of a constraint conflict computed by 'findConflictLevel()'
+    bool                conflict_reason_valid;
+
+    // Trail saving: literals (in trail order) removed by the last backtrack, with their clause reasons
+    // (CRef_Undef for decisions and literals implied by constraints).
+    vec<Lit>            saved_trail;
+    vec<CRef>           saved_reasons;
+    int                 saved_head;           // Next literal of 'saved_trail' to be replayed
+    vec<Lit>            proof_explanations;   // Constraint explanations of the current conflict for the proof, each followed by lit_Undef
+    bool                explain_propagations; // Log the explanations of constraints when propagating above level 0 (probing, vivification)
+
+    // LRAT proofs: the input clauses have the IDs 1, 2, ... in the order of the calls to 'addClause_()'.
+    // Only conflict analysis and the level 0 propagation give lemmas: other simplifications, which
+    // do not give hints, must be disabled.
+    uint64_t            proof_id;             // ID of the last clause of the proof
+    vec<uint64_t>       unit_ids;             // ID of the unit clause of each variable at level 0 (0 if not written yet)
+    int                 lrat_trail;           // The literals of 'trail' before this index have their unit clause
+    bool                lrat_empty;           // The empty clause was written
+    bool                lrat_input;           // Input clauses may still be added: lemmas are queued in 'lrat_queue'
+    uint64_t            lrat_n_queued;        // Number of lemmas in 'lrat_queue'
+    vec<uint64_t>       lrat_queue;           // Lemmas (0, #literals, literals, #hints, hints) and deletions (1, #IDs, IDs)
+    vec<uint64_t>       lrat_hints;           // Hints of the last learnt clause
+    vec<CRef>           lrat_bin;             // Binary clauses which removed literals in 'minimisationWithBinaryResolution()'
+    vec<char>           lrat_seen;
+    vec<Var>            lrat_toclear;
+    vec<std::pair<CRef, int> > lrat_stack;
+
     unsigned int  MYFLAG;
 
     // Initial reduceDB strategy
@@ -425,11 +567,15 @@ protected:
     Lit      pickBranchLit    ();                                                      // Return the next decision variable.
     void     newDecisionLevel ();                                                      // Begins a new decision level.
     void     uncheckedEnqueue (Lit p, CRef from = CRef_Undef);                         // Enqueue a literal. Assumes value of literal is undefined.
+    void     uncheckedEnqueue (Lit p, int level, CRef from);                           // Enqueue a literal at a given (possibly lower) level.
     bool     enqueue          (Lit p, CRef from = CRef_Undef);                         // Test if fact 'p' contradicts current state, enqueue otherwise.
     std::pair<CRef, Constraint*> propagate();                                          // Perform unit propagation. Returns possibly conflicting clause.
     CRef     propagateUnaryWatches(Lit p);                                                  // Perform propagation on unary watches of p, can find only conflicts
     void     cancelUntil      (int level);                                             // Backtrack until a certain level.
-    void     analyze          (CRef confl, Constraint* constr, vec<Lit>& out_learnt, vec<Lit> & selectors, int& out_btlevel,unsigned int &nblevels,unsigned int &szWithoutSelectors);    // (bt = backtrack)
+    void     replaySavedTrail ();                                                      // Enqueue the saved implications that are still unit (trail saving)
+    void     clearSavedTrail  ();
+    void     analyze          (CRef confl, Constraint* constr, int confl_level, vec<Lit>& out_learnt, vec<Lit> & selectors, int& out_btlevel,unsigned int &nblevels,unsigned int &szWithoutSelectors);    // (bt = backtrack)
+    int      findConflictLevel(std::pair<CRef, Constraint*> confl, bool& single);   // Highest level in a conflict (chronological backtracking)
     void     analyzeFinal     (Lit p, vec<Lit>& out_conflict);                         // COULD THIS BE IMPLEMENTED BY THE ORDINARIY "analyze" BY SOME REASONABLE GENERALIZATION?
     bool     litRedundant     (Lit p, uint32_t abstract_levels);                       // (helper method for 'analyze()')
     lbool    search           (int nof_conflicts);                                     // Search for a given number of conflicts.
@@ -437,8 +583,32 @@ protected:
     virtual void     reduceDB         ();                                              // Reduce the set of learnt clauses.
     void     removeSatisfied  (vec<CRef>& cs);                                         // Shrink 'cs' to contain only non-satisfied clauses.
     void     rebuildOrderHeap ();
+    void     vmtfEnqueue      (Var x);                                                 // Put a variable at the front of the VMTF queue.
+    void     vmtfDequeue      (Var x);
+    void     vmtfBumpQueue    ();                                                      // Move the variables bumped by 'analyze()' to the front.
+    Var      vmtfNextVar      ();
 
     void     adaptSolver();                                                            // Adapt solver strategies
+    virtual bool inprocess    () { return true; }                                     // Hook called at level 0 between restarts; FALSE if UNSAT
+    void     switchMode       ();                                                      // Switch between focused and stable mode
+    void     updateTargetPhases(int conflict_level);                                   // Save target/best phases from the trail below 'conflict_level'
+    void     rephase          ();                                                      // Reset the saved phases (original, best, inverted or random)
+    bool     vivifyLearnts    ();                                                      // Shorten learnt clauses by propagation (at level 0)
+    bool     vivifyClause     (CRef cr);                                               // Vivify one learnt clause; false on a top level conflict
+    bool     probe            ();                                                      // Failed literal probing and hyper-binary resolution (at level 0)
+    bool     probeLit         (Lit p);                                                 // Propagate 'p' at level 1; false on conflict (level 1 is kept)
+    bool     probeUnit        (Lit p, Lit q = lit_Undef);                              // Add unit 'p' found by probing 'q' and '~q' (or a failed literal)
+    Lit      probeDominator   (Lit p, Lit q) const;                                    // Closest common dominator of 'p' and 'q' in the probe's implication tree
+    void     explainToProof   (Constraint* constr, Lit p, const vec<Lit>& reason);    // Queue the explanation of 'p' (lit_Undef: a conflict) for the proof
+    void     writeExplanations(bool deletion);                                         // Log the queued explanations as lemmas or deletions
+    void     explainPropagations(Constraint* constr, int from, bool conflict);         // Log the explanations of the literals implied by 'constr' from 'trail[from]'
+    void     deleteFromProof  (CRef cr);                                               // Log the deletion of a clause
+    void     lratDelete       (uint64_t id);                                           // Log the deletion of a clause by its LRAT ID
+    void     lratEndInput     ();                                                      // Write the queued lemmas, after the input clauses
+    uint64_t writeLemma       (const vec<Lit>& lits, const vec<uint64_t>& hints);      // Log an LRAT lemma and return its ID
+    void     setUnitId        (Var v, uint64_t id);                                    // 'id' is the unit clause of 'v' (at level 0)
+    void     lratUnits        (CRef confl);                                            // Log the units of the new literals at level 0, and the empty clause if 'confl'
+    void     lratChain        (CRef confl, const vec<Lit>& learnt);                    // Compute the hints of a learnt clause in 'lrat_hints'
 
     void     addNumPendingPropagation (Lit p, int inc);
 
@@ -453,6 +623,7 @@ protected:
     // Operations on clauses:
     //
     void     attachClause     (CRef cr);               // Attach a clause to watcher lists.
+    virtual void adoptClause  (CRef cr);               // Make a clause allocated in 'ca' a problem clause.
     void     detachClause     (CRef cr, bool strict = false); // Detach a clause to watcher lists.
     void     detachClausePurgatory(CRef cr, bool strict = false);
     void     attachClausePurgatory(CRef cr);
@@ -501,8 +672,12 @@ inline CRef Solver::reason(Var x) const { return vardata[x].reason; }
 inline Constraint* Solver::nc_reason(Var x) const { return vardata[x].nc_reason; }
 inline int  Solver::level (Var x) const { return vardata[x].level; }
 
+inline void Solver::clearSavedTrail() { saved_trail.clear(); saved_reasons.clear(); saved_head = 0; }
+
 inline void Solver::insertVarOrder(Var x) {
-    if (!order_heap.inHeap(x) && decision[x]) order_heap.insert(x); }
+    if (vmtf) {
+        if (vmtf_search == var_Undef || vmtf_stamp[x] > vmtf_stamp[vmtf_search]) vmtf_search = x; }
+    else if (!order_heap.inHeap(x) && decision[x]) order_heap.insert(x); }
 
 inline void Solver::varDecayActivity() { var_inc *= (1 / var_decay); }
 inline void Solver::varBumpActivity(Var v) { varBumpActivity(v, var_inc); }
@@ -511,10 +686,13 @@ inline void Solver::varBumpActivity(Var v, double inc) {
         // Rescale:
         for (int i = 0; i < nVars(); i++)
             activity[i] *= 1e-100;
-        var_inc *= 1e-100; }
+        var_inc *= 1e-100;
+        order_heap.refreshKeys(); }
 
-    // Update order_heap with respect to new activity:
-    if (order_heap.inHeap(v))
+    // Update order_heap (or the VMTF queue, once analysis is done) with respect to new activity:
+    if (vmtf)
+        vmtf_bumped.push(v);
+    else if (order_heap.inHeap(v))
         order_heap.decrease(v); }
 
 inline void Solver::claDecayActivity() { cla_inc *= (1 / clause_decay); }
@@ -567,7 +745,19 @@ inline std::string Solver::varName (Var x) const {
         return "<" + std::to_string(x) + ">";
     }
 }
-inline void     Solver::setPolarity   (Var v, bool b) { polarity[v] = b; }
+inline void     Solver::setPolarity   (Var v, bool b) { polarity[v] = orig_polarity[v] = b; }
+template<class Lits>
+inline void Solver::writeProofClause(const Lits& lits, bool deletion, Lit skip)
+{
+    if (!certifiedUNSAT) return;
+    assert(!lrat);
+    ProofWriter& w = proofWriter();
+    w.beginClause(deletion);
+    for (int i = 0; i < lits.size(); i++)
+        if (lits[i] != skip) w.addLit(lits[i]);
+    w.endClause();
+}
+
 inline void     Solver::setDecisionVar(Var v, bool b) 
 { 
     if      ( b && !decision[v]) stats[dec_vars]++;
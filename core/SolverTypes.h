@@ -151,7 +151,7 @@ inline lbool toLbool(int   v) { return lbool((uint8_t)v);  }
 class Clause;
 typedef RegionAllocator<uint32_t>::Ref CRef;
 
-#define BITS_LBD 20 
+#define BITS_LBD 19 
 #ifdef INCREMENTAL
   #define BITS_SIZEWITHOUTSEL 19
 #endif
@@ -161,11 +161,13 @@ class Clause {
       unsigned mark       : 2;
       unsigned learnt     : 1;
       unsigned canbedel   : 1;
-      unsigned extra_size : 2; // extra size (end of 32bits) 0..3       
+      unsigned extra_size : 2; // extra size (end of 32bits) 0..3: 1 for learnts, 2 for abstractions, 3 for imported
       unsigned seen       : 1;
       unsigned reloced    : 1;
       unsigned exported   : 2; // Values to keep track of the clause status for exportations
       unsigned oneWatched : 1;
+      unsigned vivified   : 1;
+      unsigned has_id     : 1; // 64 bits LRAT clause ID stored after the extra fields
       unsigned lbd : BITS_LBD;
 
       unsigned size       : BITS_REALSIZE;
@@ -181,7 +183,7 @@ class Clause {
 
     // NOTE: This constructor cannot be used directly (doesn't allocate enough memory).
     template<class V>
-    Clause(const V& ps, int _extra_size, bool learnt) {
+    Clause(const V& ps, int _extra_size, bool learnt, bool has_id = false) {
 	assert(_extra_size < (1<<2));
         header.mark      = 0;
         header.learnt    = learnt;
@@ -192,42 +194,45 @@ class Clause {
 	header.canbedel = 1;
 	header.exported = 0; 
 	header.oneWatched = 0;
+	header.vivified = 0;
 	header.seen = 0;
+	header.has_id = has_id;
         for (int i = 0; i < ps.size(); i++) 
             data[i].lit = ps[i];
 	
         if (header.extra_size > 0){
-	  if (header.learnt) 
+	  if (header.learnt) {
                 data[header.size].act = 0; 
-            else 
+	      if (header.extra_size > 1) {
+	          data[header.size+1].abs = 0; // learntFrom
+	      }
+	  } else
                 calcAbstraction();
-	  if (header.extra_size > 1) {
-	      data[header.size+1].abs = 0; // learntFrom
-	  }	      
 	}
+        if (header.has_id) setId(0);
     }
 
 public:
+    // 64 bits signature of the variables, stored in the two extra words of a non-learnt clause
     void calcAbstraction() {
-        assert(header.extra_size > 0);
-        uint32_t abstraction = 0;
+        assert(!header.learnt && header.extra_size > 1);
+        uint64_t abstraction = 0;
         for (int i = 0; i < size(); i++)
-            abstraction |= 1 << (var(data[i].lit) & 31);
-        data[header.size].abs = abstraction;  }
+            abstraction |= (uint64_t)1 << (var(data[i].lit) & 63);
+        data[header.size].abs   = (uint32_t)abstraction;
+        data[header.size+1].abs = (uint32_t)(abstraction >> 32); }
 
     int          size        ()      const   { return header.size; }
     void         shrink      (int i)         { assert(i <= size()); 
-						if (header.extra_size > 0) {
-						    data[header.size-i] = data[header.size];
-						    if (header.extra_size > 1) { // Special case for imported clauses
-							data[header.size-i-1] = data[header.size-1];
-						    }
-						}
+						for (int k = 0; k < tail_size(); k++)
+						    data[header.size-i+k] = data[header.size+k];
     header.size -= i; }
     void         pop         ()              { shrink(1); }
     bool         learnt      ()      const   { return header.learnt; }
     void         nolearnt    ()              { header.learnt = false;}
     bool         has_extra   ()      const   { return header.extra_size > 0; }
+    int          extra_size  ()      const   { return header.extra_size; }
+    int          tail_size   ()      const   { return header.extra_size + 2 * header.has_id; }  // Words after the literals
     uint32_t     mark        ()      const   { return header.mark; }
     void         mark        (uint32_t m)    { header.mark = m; }
     const Lit&   last        ()      const   { return data[header.size-1].lit; }
@@ -243,12 +248,19 @@ public:
     operator const Lit* (void) const         { return (Lit*)data; }
 
     float&       activity    ()              { assert(header.extra_size > 0); return data[header.size].act; }
-    uint32_t     abstraction () const        { assert(header.extra_size > 0); return data[header.size].abs; }
+    uint64_t     abstraction () const        { assert(!header.learnt && header.extra_size > 1);
+                                               return data[header.size].abs | ((uint64_t)data[header.size+1].abs << 32); }
+
+    bool         hasId       ()      const   { return header.has_id; }
+    uint64_t     id          ()      const   { assert(header.has_id); uint32_t k = header.size + header.extra_size;
+                                               return data[k].abs | ((uint64_t)data[k+1].abs << 32); }
+    void         setId       (uint64_t i)    { assert(header.has_id); uint32_t k = header.size + header.extra_size;
+                                               data[k].abs = (uint32_t)i; data[k+1].abs = (uint32_t)(i >> 32); }
 
     // Handle imported clauses lazy sharing
-    bool        wasImported() const {return header.extra_size > 1;}
-    uint32_t    importedFrom () const       { assert(header.extra_size > 1); return data[header.size + 1].abs;}
-    void setImportedFrom(uint32_t ifrom) {assert(header.extra_size > 1); data[header.size+1].abs = ifrom;}
+    bool        wasImported() const {return header.extra_size > 2;}
+    uint32_t    importedFrom () const       { assert(wasImported()); return data[header.size + 1].abs;}
+    void setImportedFrom(uint32_t ifrom) {assert(wasImported()); data[header.size+1].abs = ifrom;}
 
     Lit          subsumes    (const Clause& other) const;
     void         strengthen  (Lit p);
@@ -263,6 +275,8 @@ public:
     unsigned int getExported() {return header.exported;}
     void setOneWatched(bool b) {header.oneWatched = b;}
     bool getOneWatched() {return header.oneWatched;}
+    void setVivified(bool b) {header.vivified = b;}
+    bool getVivified() {return header.vivified;}
 #ifdef INCREMNENTAL
     void setSizeWithoutSelectors   (unsigned int n)              {header.szWithoutSelectors = n; }
     unsigned int        sizeWithoutSelectors   () const        { return header.szWithoutSelectors; }
@@ -282,24 +296,29 @@ public:
             return (sizeof(Clause) + (sizeof(Lit) * (size + extra_size))) / sizeof(uint32_t); }
     public:
         bool extra_clause_field;
+        bool clause_ids;          // Give an LRAT ID to every clause
 
-        ClauseAllocator(uint32_t start_cap) : RegionAllocator<uint32_t>(start_cap), extra_clause_field(false){}
-        ClauseAllocator() : extra_clause_field(false){}
+        ClauseAllocator(uint32_t start_cap) : RegionAllocator<uint32_t>(start_cap), extra_clause_field(false), clause_ids(false){}
+        ClauseAllocator() : extra_clause_field(false), clause_ids(false){}
 
         void moveTo(ClauseAllocator& to){
             to.extra_clause_field = extra_clause_field;
+            to.clause_ids = clause_ids;
             RegionAllocator<uint32_t>::moveTo(to); }
 
+        // Reserve room for 'n_clauses' problem clauses with 'n_lits' literals in total:
+        void reserve(int n_clauses, int n_lits){
+            capacity(size() + n_clauses * clauseWord32Size(0, (extra_clause_field ? 2 : 0) + (clause_ids ? 2 : 0)) + n_lits); }
+
         template<class Lits>
         CRef alloc(const Lits& ps, bool learnt = false, bool imported = false)
         {
             assert(sizeof(Lit)      == sizeof(uint32_t));
             assert(sizeof(float)    == sizeof(uint32_t));
 
-            bool use_extra = learnt | extra_clause_field;
-            int extra_size = imported?3:(use_extra?1:0);
-            CRef cid = RegionAllocator<uint32_t>::alloc(clauseWord32Size(ps.size(), extra_size));
-            new (lea(cid)) Clause(ps, extra_size, learnt);
+            int extra_size = imported ? 3 : learnt ? 1 : extra_clause_field ? 2 : 0;
+            CRef cid = RegionAllocator<uint32_t>::alloc(clauseWord32Size(ps.size(), extra_size + (clause_ids ? 2 : 0)));
+            new (lea(cid)) Clause(ps, extra_size, learnt, clause_ids);
 
             return cid;
         }
@@ -314,7 +333,7 @@ public:
         void free(CRef cid)
         {
             Clause& c = operator[](cid);
-            RegionAllocator<uint32_t>::free(clauseWord32Size(c.size(), c.has_extra()));
+            RegionAllocator<uint32_t>::free(clauseWord32Size(c.size(), c.tail_size()));
         }
 
         void reloc(CRef& cr, ClauseAllocator& to)
@@ -329,6 +348,8 @@ public:
             // Copy extra data-fields:
             // (This could be cleaned-up. Generalize Clause-constructor to be applicable here instead?)
             to[cr].mark(c.mark());
+            to[cr].setVivified(c.getVivified());
+            if (to[cr].hasId()) to[cr].setId(c.hasId() ? c.id() : 0);
             if (to[cr].learnt())        {
                 to[cr].activity() = c.activity();
                 to[cr].setLBD(c.lbd());
@@ -365,6 +386,7 @@ class OccLists
     OccLists(const Deleted& d) : deleted(d) {}
     
     void  init      (const Idx& idx){ occs.growTo(toInt(idx)+1); dirty.growTo(toInt(idx)+1, 0); }
+    void  capacity  (int n)         { occs.capacity(n); dirty.capacity(n); }  // Reserve room for 'n' indices
     // Vec&  operator[](const Idx& idx){ return occs[toInt(idx)]; }
     Vec&  operator[](const Idx& idx){ return occs[toInt(idx)]; }
     Vec&  lookup    (const Idx& idx){ if (dirty[toInt(idx)]) clean(idx); return occs[toInt(idx)]; }
@@ -479,8 +501,7 @@ inline Lit Clause::subsumes(const Clause& other) const
     //if (other.size() < size() || (extra.abst & ~other.extra.abst) != 0)
     //if (other.size() < size() || (!learnt() && !other.learnt() && (extra.abst & ~other.extra.abst) != 0))
     assert(!header.learnt);   assert(!other.header.learnt);
-    assert(header.extra_size > 0); assert(other.header.extra_size > 0);
-    if (other.header.size < header.size || (data[header.size].abs & ~other.data[other.header.size].abs) != 0)
+    if (other.header.size < header.size || (abstraction() & ~other.abstraction()) != 0)
         return lit_Error;
 
     Lit        ret = lit_Undef;
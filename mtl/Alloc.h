@@ -22,6 +22,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define Glucose_Alloc_h
 
 #include <cstdlib>
+#include <cstring>
 
 #include "mtl/XAlloc.h"
 #include "mtl/Vec.h"
@@ -39,6 +40,7 @@ class RegionAllocator
     uint32_t  cap;
     uint32_t  wasted_;
 
+ protected:
     void capacity(uint32_t min_cap);
 
  public:
@@ -82,6 +84,13 @@ class RegionAllocator
         sz = cap = wasted_ = 0;
     }
 
+    // Allocate a copy of the 'size' elements of 'data':
+    Ref      append(const T* data, uint32_t size) {
+        Ref r = alloc(size);
+        memcpy(&memory[r], data, sizeof(T)*size);
+        return r;
+    }
+
     void copyTo(RegionAllocator& to) const {
      //   if (to.memory != NULL) ::free(to.memory);
         to.memory = (T*)xrealloc(to.memory, sizeof(T)*cap);
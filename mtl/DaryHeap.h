@@ -0,0 +1,158 @@
+#ifndef Glucose_DaryHeap_h
+#define Glucose_DaryHeap_h
+
+#include "mtl/Vec.h"
+
+namespace Glucose {
+
+//=================================================================================================
+// A d-ary heap with the same interface as 'Heap'. The keys are stored next to the heap entries,
+// so that comparisons do not have to look them up in another array. The comparator must provide:
+//
+//   typedef ... Key;
+//   Key  key  (int n)          const;   // Current key of element 'n'
+//   bool keyLt(Key a, Key b)   const;   // The heap is a minimum-heap with respect to this order
+//
+// The stored key of an element is refreshed by 'decrease()', 'increase()', 'update()' and
+// 'insert()'. If all keys change in an order preserving way (e.g. rescaling), call 'refreshKeys()'.
+
+
+template<class Comp, int D = 4>
+class DaryHeap {
+    typedef typename Comp::Key Key;
+    struct Elem { Key key; int n; };
+
+    Comp      lt;
+    vec<Elem> heap;     // Heap of integers, with their keys
+    vec<int>  indices;  // Each integers position (index) in the Heap
+
+    // Index "traversal" functions
+    static inline int firstChild(int i) { return i*D+1; }
+    static inline int parent    (int i) { return (i-1) / D; }
+
+
+    void percolateUp(int i)
+    {
+        Elem x = heap[i];
+
+        while (i != 0){
+            int p = parent(i);
+            if (!lt.keyLt(x.key, heap[p].key)) break;
+            heap[i]            = heap[p];
+            indices[heap[i].n] = i;
+            i                  = p;
+        }
+        heap   [i]   = x;
+        indices[x.n] = i;
+    }
+
+
+    void percolateDown(int i)
+    {
+        Elem x = heap[i];
+        while (firstChild(i) < heap.size()){
+            int child = firstChild(i);
+            int end   = child + D < heap.size() ? child + D : heap.size();
+            for (int c = child + 1; c < end; c++)
+                if (lt.keyLt(heap[c].key, heap[child].key))
+                    child = c;
+            if (!lt.keyLt(heap[child].key, x.key)) break;
+            heap[i]            = heap[child];
+            indices[heap[i].n] = i;
+            i                  = child;
+        }
+        heap   [i]   = x;
+        indices[x.n] = i;
+    }
+
+
+  public:
+    DaryHeap(const Comp& c) : lt(c) { }
+
+    int  size      ()          const { return heap.size(); }
+    bool empty     ()          const { return heap.size() == 0; }
+    bool inHeap    (int n)     const { return n < indices.size() && indices[n] >= 0; }
+    int  operator[](int index) const { assert(index < heap.size()); return heap[index].n; }
+
+
+    void decrease  (int n) { assert(inHeap(n)); heap[indices[n]].key = lt.key(n); percolateUp  (indices[n]); }
+    void increase  (int n) { assert(inHeap(n)); heap[indices[n]].key = lt.key(n); percolateDown(indices[n]); }
+
+    void copyTo(DaryHeap& copy) const {heap.copyTo(copy.heap);indices.copyTo(copy.indices);}
+    void capacity(int n) { indices.capacity(n); heap.capacity(n); }  // Reserve room for the elements 0..n-1
+
+    // Safe variant of insert/decrease/increase:
+    void update(int n)
+    {
+        if (!inHeap(n))
+            insert(n);
+        else {
+            heap[indices[n]].key = lt.key(n);
+            percolateUp(indices[n]);
+            percolateDown(indices[n]); }
+    }
+
+
+    void insert(int n)
+    {
+        indices.growTo(n+1, -1);
+        assert(!inHeap(n));
+
+        Elem e;
+        e.key = lt.key(n);
+        e.n   = n;
+        indices[n] = heap.size();
+        heap.push(e);
+        percolateUp(indices[n]);
+    }
+
+
+    int  removeMin()
+    {
+        int x              = heap[0].n;
+        heap[0]            = heap.last();
+        indices[heap[0].n] = 0;
+        indices[x]         = -1;
+        heap.pop();
+        if (heap.size() > 1) percolateDown(0);
+        return x;
+    }
+
+
+    // Rebuild the heap from scratch, using the elements in 'ns':
+    void build(vec<int>& ns) {
+        for (int i = 0; i < heap.size(); i++)
+            indices[heap[i].n] = -1;
+        heap.clear();
+
+        for (int i = 0; i < ns.size(); i++){
+            indices.growTo(ns[i]+1, -1);
+            indices[ns[i]] = i;
+            Elem e;
+            e.key = lt.key(ns[i]);
+            e.n   = ns[i];
+            heap.push(e); }
+
+        for (int i = heap.size() > 1 ? parent(heap.size() - 1) : -1; i >= 0; i--)
+            percolateDown(i);
+    }
+
+    // Reload all keys, assuming that their relative order did not change:
+    void refreshKeys() {
+        for (int i = 0; i < heap.size(); i++)
+            heap[i].key = lt.key(heap[i].n);
+    }
+
+    void clear(bool dealloc = false)
+    {
+        for (int i = 0; i < heap.size(); i++)
+            indices[heap[i].n] = -1;
+        heap.clear(dealloc);
+    }
+};
+
+
+//=================================================================================================
+}
+
+#endif
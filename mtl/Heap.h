@@ -86,6 +86,7 @@ class Heap {
     void increase  (int n) { assert(inHeap(n)); percolateDown(indices[n]); }
 
     void copyTo(Heap& copy) const {heap.copyTo(copy.heap);indices.copyTo(copy.indices);}
+    void capacity(int n) { indices.capacity(n); heap.capacity(n); }  // Reserve room for the elements 0..n-1
 
     // Safe variant of insert/decrease/increase:
     void update(int n)
@@ -128,6 +129,7 @@ class Heap {
         heap.clear();
 
         for (int i = 0; i < ns.size(); i++){
+            indices.growTo(ns[i]+1, -1);
             indices[ns[i]] = i;
             heap.push(ns[i]); }
 
@@ -135,6 +137,9 @@ class Heap {
             percolateDown(i);
     }
 
+    // Keys are read through the comparator, so there is nothing to reload (see 'DaryHeap'):
+    void refreshKeys() { }
+
     void clear(bool dealloc = false) 
     { 
         for (int i = 0; i < heap.size(); i++)
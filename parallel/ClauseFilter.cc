@@ -0,0 +1,62 @@
+#include "parallel/ClauseFilter.h"
+
+using namespace Glucose;
+
+
+ClauseFilter::ClauseFilter() : mask(0), agePeriod(0), epoch(0), nbInserted(0) {}
+
+
+void ClauseFilter::init(int log2size)
+{
+    if (log2size == 0){
+        buckets.reset();
+        return; }
+    uint64_t nbBuckets = (uint64_t)1 << (log2size > 3 ? log2size - 3 : 0);
+    buckets.reset(new Bucket[nbBuckets]);
+    for (uint64_t i = 0; i < nbBuckets; i++)
+        for (int j = 0; j < bucketSize; j++)
+            buckets[i].entries[j].store(0, std::memory_order_relaxed);
+    mask      = nbBuckets - 1;
+    agePeriod = nbBuckets * bucketSize / maxAge;
+    epoch     .store(0, std::memory_order_relaxed);
+    nbInserted.store(0, std::memory_order_relaxed);
+}
+
+
+bool ClauseFilter::insert(uint64_t h)
+{
+    Bucket&  b = buckets[h & mask];
+    uint64_t t = tag(h);
+    uint32_t e = epoch.load(std::memory_order_relaxed) & 0xFFFF;
+
+    int      victim = 0;
+    uint32_t oldest = 0;
+    uint64_t replaced = 0;
+    for (int i = 0; i < bucketSize; i++){
+        uint64_t entry = b.entries[i].load(std::memory_order_relaxed);
+        uint32_t a     = age(entry, e);
+        if ((entry & ~(uint64_t)0xFFFF) == t && a < maxAge){
+            if (a > 0) b.entries[i].compare_exchange_strong(entry, t | e, std::memory_order_relaxed);
+            return false; }
+        if (a >= oldest) victim = i, oldest = a, replaced = entry;
+    }
+    // Another thread may have replaced the entry meanwhile: then 'h' is just not remembered
+    b.entries[victim].compare_exchange_strong(replaced, t | e, std::memory_order_relaxed);
+
+    if (nbInserted.fetch_add(1, std::memory_order_relaxed) % agePeriod == agePeriod - 1)
+        epoch.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+
+bool ClauseFilter::contains(uint64_t h) const
+{
+    const Bucket& b = buckets[h & mask];
+    uint64_t t = tag(h);
+    uint32_t e = epoch.load(std::memory_order_relaxed) & 0xFFFF;
+    for (int i = 0; i < bucketSize; i++){
+        uint64_t entry = b.entries[i].load(std::memory_order_relaxed);
+        if ((entry & ~(uint64_t)0xFFFF) == t && age(entry, e) < maxAge)
+            return true; }
+    return false;
+}
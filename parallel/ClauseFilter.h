@@ -0,0 +1,74 @@
+#ifndef Glucose_ClauseFilter_h
+#define Glucose_ClauseFilter_h
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
+#include "mtl/Vec.h"
+#include "mtl/Sort.h"
+#include "core/SolverTypes.h"
+
+namespace Glucose {
+
+//=================================================================================================
+// Lock-free filter of the clauses seen recently, by hash (see 'hash()'). The table is made of
+// buckets of 8 entries; each entry keeps the epoch at which its hash was last inserted, and the
+// epoch advances every time a quarter of the entries have been inserted, so that a hash is
+// forgotten after about as many insertions as there are entries. Concurrent insertions may lose
+// entries, i.e. the filter may let a duplicate through, never the reverse (up to hash collisions).
+
+class ClauseFilter {
+public:
+    ClauseFilter();
+
+    void init    (int log2size);              // Not thread-safe: allocates 2^log2size entries (none if 0)
+    bool enabled () const { return buckets != nullptr; }
+
+    bool insert  (uint64_t h);                // False if 'h' was seen recently (it is then refreshed)
+    bool contains(uint64_t h) const;
+
+    // Hash of the clause, whatever the order of its literals ('tmp' is a scratch buffer)
+    template<class Lits>
+    static uint64_t hash(const Lits& c, vec<Lit>& tmp);
+
+private:
+    static const int      bucketSize = 8;
+    static const uint32_t maxAge     = 4;
+
+    struct alignas(64) Bucket {
+        std::atomic<uint64_t> entries[bucketSize]; // Hash bits, then the epoch in the low 16 bits (0: empty)
+    };
+
+    static uint64_t tag(uint64_t h) { return (h | (uint64_t)1 << 63) & ~(uint64_t)0xFFFF; }
+    uint32_t age(uint64_t entry, uint32_t e) const { return entry == 0 ? 65536 : (e - (uint32_t)entry) & 0xFFFF; }
+
+    std::unique_ptr<Bucket[]> buckets;
+    uint64_t                  mask;        // Number of buckets - 1
+    uint64_t                  agePeriod;   // Insertions between two epochs
+    std::atomic<uint32_t>     epoch;
+    alignas(64) std::atomic<uint64_t> nbInserted;
+};
+
+
+template<class Lits>
+uint64_t ClauseFilter::hash(const Lits& c, vec<Lit>& tmp)
+{
+    tmp.clear();
+    for (int i = 0; i < c.size(); i++) tmp.push(c[i]);
+    sort(tmp);
+
+    uint64_t h = tmp.size();
+    for (int i = 0; i < tmp.size(); i++){
+        h = (h ^ (uint64_t)toInt(tmp[i])) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 29; }
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ULL;
+    return h ^ (h >> 32);
+}
+
+//=================================================================================================
+}
+
+#endif
@@ -49,22 +49,20 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 /* ClausesBuffer
  *
- * This class is responsible for exchanging clauses between threads.
- * It is based on a fixed-length FIFO array of literals.
- * If the FIFO is full, then old clauses are removed (even if it was not yet sent to all threads)
+ * This class is responsible for exchanging clauses between threads, without locks.
+ * Each thread owns a fixed-length ring of literals in which it is the only writer, and keeps in
+ * the ring of each other thread the position of the next clause to read.
  *
- * a clause " l1 l2 l3" is pushed in the FIFO with the following 6 unsigned integers
- * 3 nseen origin l1 l2 l3
+ * a clause " l1 l2 l3" is pushed in the ring of its thread with the following 4 unsigned integers
+ * 3 l1 l2 l3
  * + 3 is the size of the pushed clause
- * + nseen is the number of thread which imported this clause (initialized with nthreads-1)
- *       (when set to 0, the clause is removed from the fifo)
- * + origin is the thread id of the thread which added this clause to the fifo
  * + l1 l2 l3 are the literals of the clause
  *
- * **********************************************************************************************
- * **CAREFUL** This class is not thread-safe. In glucose-syrup, the SharedCompanion is 
- * responsible for ensuring atomicity of main functions
- * **********************************************************************************************
+ * The writer announces the end of the clause in 'reserved' before writing it, and in 'published'
+ * once it is written. Readers read up to 'published'.
+ * If the ring is full, then either the clause is not added (until the slowest reader catches up),
+ * or, with whenFullRemoveOlder, the writer overwrites the oldest clauses: a reader checks
+ * 'reserved' after reading a clause, and skips what it has missed when the clause was overwritten.
  *
  * */
 
@@ -77,159 +75,93 @@ using namespace Glucose;
 extern BoolOption opt_whenFullRemoveOlder;
 extern IntOption  opt_fifoSizeByCore;
 
-// index : size clause
-// index + 1 : nbSeen
-// index + 2 : threadId
-// index + 3 : .. index + 3 + size : Lit of clause
-ClausesBuffer::ClausesBuffer(int _nbThreads, unsigned int _maxsize) : first(0), last(_maxsize-1),  
-    maxsize(_maxsize), queuesize(0), 
-    removedClauses(0),
-    forcedRemovedClauses(0), nbThreads(_nbThreads), 
-    whenFullRemoveOlder(opt_whenFullRemoveOlder), fifoSizeByCore(opt_fifoSizeByCore) {
-	lastOfThread.growTo(_nbThreads);
-	for(int i=0;i<nbThreads;i++) lastOfThread[i] = _maxsize-1;
-	elems.growTo(maxsize);
-} 
-
-ClausesBuffer::ClausesBuffer() : first(0), last(0), maxsize(0), queuesize(0), removedClauses(0), forcedRemovedClauses(0), nbThreads(0),
+ClausesBuffer::ClausesBuffer() : capacity(0), nbThreads(0),
                                  whenFullRemoveOlder(opt_whenFullRemoveOlder), fifoSizeByCore(opt_fifoSizeByCore) {}
 
 void ClausesBuffer::setNbThreads(int _nbThreads) {
-    unsigned int _maxsize = fifoSizeByCore*_nbThreads;
-    last = _maxsize -1;
-    maxsize = _maxsize;
+    capacity = 1;
+    while (capacity < fifoSizeByCore) capacity *= 2;
     nbThreads = _nbThreads;
-    lastOfThread.growTo(_nbThreads);
-    for(int i=0;i<nbThreads;i++) lastOfThread[i] = _maxsize-1;
-    elems.growTo(maxsize);
-}
-
-uint32_t ClausesBuffer::getCap() {
-    return elems.capacity();
-}
-inline unsigned int ClausesBuffer::nextIndex(unsigned int i) {
-    i++;
-    if (i == maxsize)
-	return 0;
-    return i;
-}
-
-inline unsigned int ClausesBuffer::addIndex(unsigned int i, unsigned int a) {
-    i += a;
-    if (i >= maxsize)
-	return i - maxsize;
-    return i;
-}
-
-void ClausesBuffer::removeLastClause() {
-    assert(queuesize > 0);
-    do {
-	unsigned int size = (unsigned int) elems[nextIndex(last)];
-	unsigned int nextlast = addIndex(last, size+headerSize);
-
-	for(int i=0;i<nbThreads;i++) {
-	    if (lastOfThread[i] == last)
-		lastOfThread[i] = nextlast;
-	}
-
-	// printf("Removing clause starting at %d of size %d.\n",nextIndex(last), size);
-	for(unsigned int i=0;i<size+headerSize;i++) {
-	    last = nextIndex(last);
-	    assert(queuesize > 0);
-	    queuesize --;
-	}	
-	removedClauses ++;
-	assert(last >= 0);
-	assert(last < maxsize);
-	assert(last == nextlast);
-    } while (queuesize > 0 && (elems[addIndex(last,2)] == 0)); 	
-
-}
-
-
-// Pushes a single uint to the fifo
-inline void ClausesBuffer::noCheckPush(uint32_t x) {
-    elems[first] = x;
-    first = nextIndex(first);
-}
-
-// Pops a single uint from the fifo
-inline uint32_t ClausesBuffer::noCheckPop(uint32_t & index) {
-    index = nextIndex(index);
-    uint32_t ret = elems[index];
-    return ret;
+    rings.reset(new Ring[nbThreads]);
+    readers.reset(new Reader[nbThreads]);
+    for(int i=0;i<nbThreads;i++) {
+	rings[i].elems.reset(new std::atomic<uint32_t>[capacity]);
+	readers[i].cursors.reset(new std::atomic<uint64_t>[nbThreads]);
+	for(int j=0;j<nbThreads;j++) readers[i].cursors[j].store(0, std::memory_order_relaxed);
+	readers[i].next = 0;
+    }
 }
 
 
-
 // Return true if the clause was succesfully added
 bool ClausesBuffer::pushClause(int threadId, Clause & c) {
-    if (!whenFullRemoveOlder && (queuesize + c.size() + headerSize >= maxsize))
-	return false; // We need to remove some old clauses
-    while (queuesize + c.size() + headerSize >= maxsize) { // We need to remove some old clauses
-	forcedRemovedClauses ++;
-	removeLastClause();
-	assert(queuesize > 0);
+    Ring& ring = rings[threadId];
+    uint64_t head = ring.published.load(std::memory_order_relaxed);
+    uint64_t end  = head + c.size() + 1;
+    if (end - head > capacity)
+	return false;
+
+    if (whenFullRemoveOlder) {
+	if (end > capacity) {
+	    ring.reserved.store(end, std::memory_order_relaxed);
+	    std::atomic_thread_fence(std::memory_order_release); // Readers see 'reserved' before the new literals
+	}
     }
-    noCheckPush(c.size());
-    noCheckPush(nbThreads>1?nbThreads-1:1);
-    noCheckPush(threadId);
+    else if (end - ring.minRead > capacity) { // Can we make room without removing clauses?
+	uint64_t minRead = head;
+	for(int i=0;i<nbThreads;i++)
+	    if (i != threadId) {
+		uint64_t r = readers[i].cursors[threadId].load(std::memory_order_acquire);
+		if (r < minRead) minRead = r;
+	    }
+	ring.minRead = minRead;
+	if (end - minRead > capacity)
+	    return false;
+    }
+
+    slot(ring, head).store(c.size(), std::memory_order_relaxed);
     for(int i=0;i<c.size();i++)
-	noCheckPush(toInt(c[i]));
-    queuesize += c.size()+headerSize;
+	slot(ring, head + 1 + i).store(toInt(c[i]), std::memory_order_relaxed);
+    ring.published.store(end, std::memory_order_release);
     return true;
-    //  printf(" -> (%d, %d)\n", first, last);
 }
 
-bool ClausesBuffer::getClause(int threadId, int & threadOrigin, vec<Lit> & resultClause,  bool firstFound) {
-    assert(lastOfThread.size() > threadId);
-    unsigned int thislast = lastOfThread[threadId];
-    assert(!firstFound || thislast == last); // FIXME: Gilles has this assertion on his cluster
-
-    // Early exiting
-    if (nextIndex(thislast) == first) return false;
-
-    if ( ( thislast < last && last < first) ||
-	    ( first < thislast && thislast < last ) ||
-	    ( last < first && first < thislast) ) {
-	// Special case where last has moved and lastOfThread[threadId] is no more valid (is behind)
-	thislast = last; 
-    }
-    assert(!firstFound);
-    // Go to next clause for this thread id
-    if (!firstFound) { 
-	while (nextIndex(thislast) != first && elems[addIndex(thislast,3)] == ((unsigned int)threadId)) { // 3 = 2 + 1 
-	    thislast = addIndex(thislast, elems[nextIndex(thislast)] + headerSize); // 
-	    assert(thislast >= 0);
-	    assert(thislast < maxsize);
+bool ClausesBuffer::getClause(int threadId, int & threadOrigin, vec<Lit> & resultClause) {
+    Reader& reader = readers[threadId];
+
+    for(int k=0;k<nbThreads;k++) {
+	int th = reader.next + k < nbThreads ? reader.next + k : reader.next + k - nbThreads;
+	if (th == threadId) continue;
+	Ring& ring = rings[th];
+	uint64_t pos  = reader.cursors[th].load(std::memory_order_relaxed);
+	uint64_t head = ring.published.load(std::memory_order_acquire);
+	if (pos == head) continue;
+
+	bool valid = head - pos <= capacity;
+	if (valid) {
+	    uint64_t size = slot(ring, pos).load(std::memory_order_relaxed);
+	    valid = size + 1 <= head - pos;
+	    if (valid) {
+		resultClause.clear();
+		for(uint64_t i=0;i<size;i++)
+		    resultClause.push(toLit(slot(ring, pos + 1 + i).load(std::memory_order_relaxed)));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		valid = ring.reserved.load(std::memory_order_relaxed) <= pos + capacity;
+		pos += size + 1;
+	    }
 	}
-	assert(nextIndex(thislast)==first || elems[addIndex(thislast,3)] != (unsigned int)threadId);
-    }
-
-    if (nextIndex(thislast) == first) {
-	lastOfThread[threadId] = thislast;
-	return false;
-    }  
-    assert(elems[addIndex(thislast,3)] != ((unsigned int) threadId));
-    unsigned int previouslast = thislast;
-    bool removeAfter = false;
-    int csize = noCheckPop(thislast);
-    removeAfter = (--elems[addIndex(thislast,1)] == 0); // We are sure this is not one of our own clause
-    thislast = nextIndex(thislast); // Skips the removeAfter fieldr
-    threadOrigin = noCheckPop(thislast);
-    assert(threadOrigin != threadId);
-    resultClause.clear();
-    for(int i=0;i<csize;i++) {
-	resultClause.push(toLit(noCheckPop(thislast)));
-    }
-    if (last == previouslast && removeAfter) {
-	removeLastClause();
-	thislast = last;
+	if (!valid) {
+	    // The writer has overwritten the clause: skip all the clauses we did not read
+	    reader.cursors[th].store(head, std::memory_order_release);
+	    continue;
+	}
+	reader.cursors[th].store(pos, std::memory_order_release);
+	reader.next = th + 1 < nbThreads ? th + 1 : 0;
+	threadOrigin = th;
+	return true;
     }
-    lastOfThread[threadId] = thislast;
-    return true;
+    return false;
 }
 
 
 //=================================================================================================
-
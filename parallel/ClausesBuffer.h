@@ -47,9 +47,13 @@ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
 OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  **************************************************************************************************/
 
+
 #ifndef ClausesBuffer_h 
 #define ClausesBuffer_h
 
+#include <atomic>
+#include <memory>
+
 #include "mtl/Vec.h"
 #include "core/SolverTypes.h"
 #include "core/Solver.h"
@@ -57,54 +61,45 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 //=================================================================================================
 
 namespace Glucose {
-    // index : size clause
-    // index + 1 : nbSeen
-    // index + 2 : threadId
-    // index + 3 : .. index + 3 + size : Lit of clause
+    // Lock-free exchange of clauses between threads: each thread owns a ring of literals in which
+    // only it writes, and keeps in each other ring the position of the next clause it will read.
+    // A clause is stored as its size followed by its literals. Positions are counted from the
+    // start (they never wrap); the slot of a position is its value modulo the capacity.
     class ClausesBuffer {
-	vec<uint32_t>  elems;
-	unsigned int     first;
-	unsigned int	 last;
-	unsigned int     maxsize;
-	unsigned int     queuesize; // Number of current elements (must be < maxsize !)
-	unsigned int     removedClauses;
-	unsigned int     forcedRemovedClauses;
-        static const int  headerSize = 3;
-	int       nbThreads;
-	bool      whenFullRemoveOlder;
+	struct alignas(64) Ring {
+	    std::unique_ptr<std::atomic<uint32_t>[]> elems;
+	    std::atomic<uint64_t> reserved;  // End of the clause being written, once it overwrites older ones
+	    std::atomic<uint64_t> published; // End of the last clause completely written
+	    uint64_t              minRead;   // Owner only: last known position of the slowest reader (if clauses are never overwritten)
+	    Ring() : reserved(0), published(0), minRead(0) {}
+	};
+
+	struct alignas(64) Reader {
+	    std::unique_ptr<std::atomic<uint64_t>[]> cursors; // Position of the next clause to read in each ring
+	    int                                      next;    // Ring to look at first
+	    Reader() : next(0) {}
+	};
+
+	std::unique_ptr<Ring[]>   rings;
+	std::unique_ptr<Reader[]> readers;
+	uint64_t     capacity;  // Of each ring (a power of 2)
+	int          nbThreads;
+	bool         whenFullRemoveOlder;
 	unsigned int fifoSizeByCore;
-	vec<unsigned int> lastOfThread; // Last value for a thread 
+
+	std::atomic<uint32_t>& slot(Ring& r, uint64_t pos) { return r.elems[pos & (capacity - 1)]; }
 
 	public:
-	ClausesBuffer(int _nbThreads, unsigned int _maxsize);
 	ClausesBuffer();
 
-	void setNbThreads(int _nbThreads);
-	unsigned int nextIndex(unsigned int i);
-	unsigned int addIndex(unsigned int i, unsigned int a); 
-	void removeLastClause(); 
-	   
-	void noCheckPush(uint32_t x);
-	uint32_t noCheckPop(unsigned int & index);
+	void setNbThreads(int _nbThreads); // Not thread-safe: must be called before the threads start
 
-	// Return true if the clause was succesfully added
+	// Return true if the clause was succesfully added. Only thread 'threadId' may add its clauses.
         bool pushClause(int threadId, Clause & c);
-        bool getClause(int threadId, int & threadOrigin, vec<Lit> & resultClause, bool firstFound = false); 
+	// Gets a clause of another thread not read yet by 'threadId'. Only thread 'threadId' may read its clauses.
+        bool getClause(int threadId, int & threadOrigin, vec<Lit> & resultClause);
 	
-	int maxSize() const {return maxsize;}
-        uint32_t getCap();
-	void growTo(int size) {
-	    assert(0); // Not implemented (essentially for efficiency reasons)
-	    elems.growTo(size); 
-	    first=0; maxsize=size; queuesize = 0;last = 0;
-	    for(int i=0;i<size;i++) elems[i]=0; 
-	}
-
-	void fastclear() {first = 0; last = 0; queuesize=0; } 
-
-	int  size(void)    { return queuesize; }
-
-	void clear(bool dealloc = false)   { elems.clear(dealloc); first = 0; maxsize=0; queuesize=0;}
+	int maxSize() const {return (int)capacity * nbThreads;}
 	inline  int  toInt     (Lit p)              { return p.x; } 
 
     };
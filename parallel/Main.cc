@@ -51,11 +51,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include <signal.h>
 
-#ifdef USE_ZLIB
-#include <zlib.h>
-#else
-#include <utils/fake_zlib.h>
-#endif
+#include <sys/resource.h>
 
 
 #include "utils/System.h"
@@ -99,7 +95,7 @@ int main(int argc, char** argv)
     double realTimeStart = realTime();
   printf("c\nc This is glucose-syrup 4.0 (glucose in many threads) --  based on MiniSAT (Many thanks to MiniSAT team)\nc\n");
     try {
-        setUsageHelp("c USAGE: %s [options] <input-file> <result-output-file>\n\n  where input may be either in plain or gzipped DIMACS.\n");
+        setUsageHelp("c USAGE: %s [options] <input-file> <result-output-file>\n\n  where input may be either in plain, gzipped or xz-compressed DIMACS.\n");
         // printf("This is MiniSat 2.0 beta\n");
         
 #if defined(__linux__)
@@ -156,8 +152,8 @@ int main(int argc, char** argv)
         if (argc == 1)
             printf("c Reading from standard input... Use '--help' for help.\n");
         
-        gzFile in = (argc == 1) ? gzdopen(0, "rb") : gzopen(argv[1], "rb");
-        if (in == NULL)
+        InputFile in((argc == 1) ? NULL : argv[1]);
+        if (!in.isOpen())
             printf("c ERROR! Could not open file: %s\n", argc == 1 ? "<stdin>" : argv[1]), exit(1);
         
         if (msolver.verbosity() > 0){
@@ -165,7 +161,6 @@ int main(int argc, char** argv)
             printf("c |                                                                                                       |\n"); }
         
         parse_DIMACS(in, msolver);
-        gzclose(in);
         
 
 	
@@ -221,24 +216,21 @@ int main(int argc, char** argv)
             msolver.printFinalStats();
             printf("\n"); }
 
-	//-------------- Result is put in a external file
-     	/* I must admit I have to print the model of one thread... But which one? FIXME !!
-	  if (res != NULL){  
-	  if (ret == l_True){
-	    fprintf(res, "SAT\n");
-	    for (int i = 0; i < S.nVars(); i++)
-	      if (S.model[i] != l_Undef)
-		fprintf(res, "%s%s%d", (i==0)?"":" ", (S.model[i]==l_True)?"":"-", i+1);
-	    fprintf(res, " 0\n");
-	  }else if (ret == l_False)
-	    fprintf(res, "UNSAT\n");
-	  else
-	    fprintf(res, "INDET\n");
-	  fclose(res);
-	
-	//-------------- Want certified output
-        } else { 
-	*/
+	//-------------- Result is put in a external file (with the model of the winner)
+        if (res != NULL){
+            if (ret == l_True){
+                fprintf(res, "SAT\n");
+                for (int i = 0; i < msolver.model.size(); i++)
+                    if (msolver.model[i] != l_Undef)
+                        fprintf(res, "%s%s%d", (i==0)?"":" ", (msolver.model[i]==l_True)?"":"-", i+1);
+                fprintf(res, " 0\n");
+            }else if (ret == l_False)
+                fprintf(res, "UNSAT\n");
+            else
+                fprintf(res, "INDET\n");
+            fclose(res);
+        }
+
 	  printf(ret == l_True ? "s SATISFIABLE\n" : ret == l_False ? "s UNSATISFIABLE\n" : "s INDETERMINATE\n");
 	  
 	  if(msolver.getShowModel() && ret==l_True) {
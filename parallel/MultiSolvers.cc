@@ -47,12 +47,11 @@ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
 OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  **************************************************************************************************/
 
-#include <pthread.h>
+#include <chrono>
 #include "parallel/MultiSolvers.h"
 #include "mtl/Sort.h"
 #include "utils/System.h"
 #include "simp/SimpSolver.h"
-#include <errno.h>
 #include <string.h>
 #include "parallel/SolverConfiguration.h"
 
@@ -70,6 +69,13 @@ static IntOption opt_statsInterval(_parallel, "statsinterval", "Seconds (real ti
 BoolOption opt_whenFullRemoveOlder(_parallel, "removeolder", "When the FIFO for exchanging clauses between threads is full, remove older clauses", false);
 IntOption opt_fifoSizeByCore(_parallel, "fifosize", "Size of the FIFO structure for exchanging clauses between threads, by threads", 100000);
 //
+// Shared with SharedCompanion.cc and ParallelSolver.cc
+IntOption opt_shareFilterSize(_parallel, "sharefilter", "log2 of the number of shared clauses remembered to filter duplicates (0 for no filter, each thread remembers 16 times less)", 20, IntRange(0, 30));
+static BoolOption opt_cubes(_parallel, "cubes", "Cube-and-conquer: split the formula into cubes solved under assumptions, instead of a portfolio", false);
+static IntOption opt_cubeBudget(_parallel, "cubeconfl", "Conflicts spent on a cube before it is split", 10000, IntRange(1, INT32_MAX));
+static IntOption opt_cubesByThread(_parallel, "cubeinit", "Number of initial cubes by thread", 4, IntRange(1, 1024));
+static IntOption opt_lookaheadCandidates(_parallel, "lookahead", "Number of variables tried by the lookahead to split a cube", 50, IntRange(1, INT32_MAX));
+//
 // Shared options with Solver.cc 
 BoolOption opt_dontExportDirectReusedClauses(_cunstable, "reusedClauses", "Don't export directly reused clauses", false);
 BoolOption opt_plingeling(_cunstable, "plingeling", "plingeling strategy for sharing clauses (exploratory feature)", false);
@@ -86,17 +92,13 @@ static inline double cpuTime(void) {
 }
 
 
-void MultiSolvers::informEnd(lbool res) {
-    result = res;
-    pthread_cond_broadcast(&cfinished);
-}
-
-
 MultiSolvers::MultiSolvers(ParallelSolver *s) :
-        use_simplification(true), ok(true), maxnbthreads(4), nbthreads(opt_nbsolversmultithreads), nbsolvers(opt_nbsolversmultithreads), nbcompanions(4), nbcompbysolver(2),
+        use_simplification(true), use_cubes(opt_cubes), cube_budget(opt_cubeBudget), cubes_by_thread(opt_cubesByThread), lookahead_candidates(opt_lookaheadCandidates),
+        ok(true), maxnbthreads(4), nbthreads(opt_nbsolversmultithreads), nbsolvers(opt_nbsolversmultithreads), nbcompanions(4), nbcompbysolver(2),
         allClonesAreBuilt(0), showModel(false), winner(-1), var_decay(1 / 0.95), clause_decay(1 / 0.999), cla_inc(1), var_inc(1), random_var_freq(0.02), restart_first(100),
         restart_inc(1.5), learntsize_factor((double) 1 / (double) 3), learntsize_inc(1.1), expensive_ccmin(true), polarity_mode(polarity_false), maxmemory(opt_maxmemory),
-        maxnbsolvers(opt_maxnbsolvers), verb(0), verbEveryConflicts(10000), numvar(0), numclauses(0) {
+        maxnbsolvers(opt_maxnbsolvers), verb(0), verbEveryConflicts(10000), numvar(0), numclauses(0), nbfinished(0),
+        nbcubesleft(0), nbcubessplit(0), nbcubesrefuted(0), nbcubesstolen(0) {
     result = l_Undef;
     SharedCompanion *sc = new SharedCompanion();
     this->sharedcomp = sc;
@@ -112,10 +114,6 @@ MultiSolvers::MultiSolvers(ParallelSolver *s) :
     sc->addSolver(s);
     assert(solvers[0]->threadNumber() == 0);
 
-    pthread_mutex_init(&m, NULL);  //PTHREAD_MUTEX_INITIALIZER;
-    pthread_mutex_init(&mfinished, NULL); //PTHREAD_MUTEX_INITIALIZER;
-    pthread_cond_init(&cfinished, NULL);
-
     if(nbsolvers > 0)
         fprintf(stdout, "c %d solvers engines and 1 companion as a blackboard created.\n", nbsolvers);
 }
@@ -126,7 +124,11 @@ MultiSolvers::MultiSolvers() : MultiSolvers(new ParallelSolver(-1)) {
 }
 
 
-MultiSolvers::~MultiSolvers() { }
+MultiSolvers::~MultiSolvers() {
+    for(int i = 0; i < solvers.size(); i++)
+        delete solvers[i];
+    delete sharedcomp;
+}
 
 
 /**
@@ -197,20 +199,28 @@ bool MultiSolvers::addClause_(vec<Lit> &ps) {
 
 
     if(ps.size() == 0) {
-        return ok = false;
+        ok = false;
+        return false;
     }
     else if(ps.size() == 1) {
-        assert(solvers[0]->value(ps[0]) == l_Undef); // TODO : Passes values to all threads
+        assert(solvers[0]->value(ps[0]) == l_Undef);
         solvers[0]->uncheckedEnqueue(ps[0]);
-        if(!allClonesAreBuilt) {
-            return ok = ((solvers[0]->propagate()) == CRef_Undef); // checks only main solver here for propagation constradiction
-        }
+        ok = !ParallelSolver::hasConflict(solvers[0]->propagate());
+        if(!allClonesAreBuilt || !ok)
+            return ok;
 
         // Here, all clones are built.
-        // Gives the unit clause to everybody
-        for(int i = 0; i < nbsolvers; i++)
-            solvers[i]->uncheckedEnqueue(ps[0]);
-        return ok = ((solvers[0]->propagate()) == CRef_Undef); // checks only main solver here for propagation constradiction
+        // Gives the unit clause to the other threads (they may already have found it)
+        for(int i = 1; i < nbsolvers; i++) {
+            if(solvers[i]->value(ps[0]) == l_False)
+                ok = false;
+            else if(solvers[i]->value(ps[0]) == l_Undef) {
+                solvers[i]->uncheckedEnqueue(ps[0]);
+                if(ParallelSolver::hasConflict(solvers[i]->propagate()))
+                    ok = false;
+            }
+        }
+        return ok;
     } else {
         //		printf("Adding clause %0xd for solver %d.\n",(void*)c, thn);
         // At the beginning only solver 0 load the formula
@@ -230,11 +240,31 @@ bool MultiSolvers::addClause_(vec<Lit> &ps) {
 }
 
 
+bool MultiSolvers::addConstraint(std::unique_ptr<Constraint> &&constr) {
+    assert(solvers[0] != NULL);
+    if(!okay()) return false;
+
+    // Like clauses, the constraints given before the clones are built are copied with solver 0
+    if(allClonesAreBuilt)
+        for(int i = 1; i < nbsolvers; i++) {
+            std::unique_ptr<Constraint> copy = constr->clone();
+            if(!copy)
+                fprintf(stderr, "ERROR! A constraint that does not implement clone() can not be copied.\n"), exit(1);
+            if(!solvers[i]->addConstraint(std::move(copy)))
+                ok = false;
+        }
+    if(!solvers[0]->addConstraint(std::move(constr)))
+        ok = false;
+    return ok;
+}
+
+
 bool MultiSolvers::simplify() {
     assert(solvers[0] != NULL); // There is at least one solver.
 
     if(!okay()) return false;
-    return ok = solvers[0]->simplify();
+    ok = solvers[0]->simplify();
+    return ok;
 }
 
 
@@ -251,16 +281,6 @@ bool MultiSolvers::eliminate() {
 }
 
 
-// TODO: Use a template here
-void *localLaunch(void *arg) {
-    ParallelSolver *s = (ParallelSolver *) arg;
-
-    (void) s->solve();
-
-    pthread_exit(NULL);
-}
-
-
 #define MAXIMUM_SLEEP_DURATION 5
 
 
@@ -301,6 +321,8 @@ void MultiSolvers::printFinalStats() {
     printf("c\n");
     printf("c |---------------------------------------- FINAL STATS --------------------------------------------------|\n");
     printf("c\n");
+    if(use_cubes)
+        printf("c Cubes: %" PRIu64" split, %" PRIu64" refuted, %" PRIu64" stolen\nc\n", nbcubessplit, nbcubesrefuted, nbcubesstolen);
 
     printf("c |---------------|-----------------");
     for(int i = 0; i < solvers.size(); i++)
@@ -407,6 +429,26 @@ void MultiSolvers::printFinalStats() {
     printf("|\n");
 //--
 
+    printf("c | Dup. exports  ");
+    uint64_t notexported = 0;
+    for(int i = 0; i < solvers.size(); i++)
+        notexported += solvers[i]->stats[nbNotExportedDuplicates];
+    printf("| %15" PRIu64" ", notexported);
+    for(int i = 0; i < solvers.size(); i++)
+        printf("| %10" PRIu64" ", solvers[i]->stats[nbNotExportedDuplicates]);
+    printf("|\n");
+//--
+
+    printf("c | Not imported  ");
+    uint64_t notimported = 0;
+    for(int i = 0; i < solvers.size(); i++)
+        notimported += solvers[i]->stats[nbNotImported];
+    printf("| %15" PRIu64" ", notimported);
+    for(int i = 0; i < solvers.size(); i++)
+        printf("| %10" PRIu64" ", solvers[i]->stats[nbNotImported]);
+    printf("|\n");
+//--
+
     printf("c | Good          ");
     uint64_t importedGood = 0;
     for(int i = 0; i < solvers.size(); i++)
@@ -602,7 +644,6 @@ void MultiSolvers::adjustNumberOfCores() {
 
 
 lbool MultiSolvers::solve() {
-    pthread_attr_t thAttr;
     int i;
 
     adjustNumberOfCores();
@@ -611,40 +652,39 @@ lbool MultiSolvers::solve() {
         printf("c |  Generating clones                                                                                    |\n");
     generateAllSolvers();
     if(verb >= 1) {
-        printf("c |  all clones generated. Memory = %6.2fMb.                                                             |\n", memUsed());
+        printf("c |  all clones generated. Memory = %6.2fMb.                                                             |\n", memUsed());
         printf("c ========================================================================================================|\n");
     }
 
 
     model.clear();
 
-    /* Initialize and set thread detached attribute */
-    pthread_attr_init(&thAttr);
-    pthread_attr_setdetachstate(&thAttr, PTHREAD_CREATE_JOINABLE);
-
-
+    if(use_cubes && !generateCubes() && sharedcomp->IFinished(solvers[0]))
+        sharedcomp->jobStatus = l_False; // The threads stop at once
 
     // Launching all solvers
-    for(i = 0; i < nbsolvers; i++) {
-        pthread_t *pt = (pthread_t *) malloc(sizeof(pthread_t));
-        threads.push(pt);
-        solvers[i]->pmfinished = &mfinished;
-        solvers[i]->pcfinished = &cfinished;
-        pthread_create(threads[i], &thAttr, &localLaunch, (void *) solvers[i]);
-    }
+    for(i = 0; i < nbsolvers; i++)
+        threads.emplace_back([this, i]() {
+            if(use_cubes)
+                solveCubes(i);
+            else
+                (void) solvers[i]->solve();
+            {
+                std::lock_guard<std::mutex> lock(mfinished);
+                nbfinished++;
+            }
+            cfinished.notify_one();
+        });
 
     bool done = false;
     bool adjustedlimitonce = false;
 
-    (void) pthread_mutex_lock(&m);
     while(!done) {
-        struct timespec timeout;
-        time(&timeout.tv_sec);
-        timeout.tv_sec += MAXIMUM_SLEEP_DURATION;
-        timeout.tv_nsec = 0;
-        if(pthread_cond_timedwait(&cfinished, &mfinished, &timeout) != ETIMEDOUT)
-            done = true;
-        else
+        {
+            std::unique_lock<std::mutex> lock(mfinished);
+            done = cfinished.wait_for(lock, std::chrono::seconds(MAXIMUM_SLEEP_DURATION), [this]() { return nbfinished > 0; });
+        }
+        if(!done)
             printStats();
 
         float mem = memUsed();
@@ -670,30 +710,130 @@ lbool MultiSolvers::solve() {
         }
     }
 
-    (void) pthread_mutex_unlock(&m);
-
-    for(i = 0; i < nbsolvers; i++) { // Wait for all threads to finish
-        pthread_join(*threads[i], NULL);
-    }
+    for(std::thread &t : threads) // Wait for all threads to finish
+        t.join();
+    threads.clear();
 
+    // The winner has already extended and copied its model (joining the threads makes it visible here)
     assert(sharedcomp != NULL);
     result = sharedcomp->jobStatus;
-    if(result == l_True) {
-        sharedcomp->jobFinishedBy->extendModel();
-        int n = sharedcomp->jobFinishedBy->nVars();
-        model.growTo(n);
-        for(int i = 0; i < n; i++) {
-            model[i] = sharedcomp->jobFinishedBy->model[i];
-            assert(model[i] != l_Undef);
+    if(result == l_True)
+        sharedcomp->jobFinishedBy->model.copyTo(model);
+
+    return result;
+}
+
+
+/**
+ * Cube-and-conquer
+ */
+
+void MultiSolvers::pushCube(int i, const vec<Lit>& cube) {
+    cubes[i].emplace_back();
+    for(int k = 0; k < cube.size(); k++)
+        cubes[i].back().push_back(cube[k]);
+    nbcubesleft++;
+}
+
+
+bool MultiSolvers::generateCubes() {
+    ParallelSolver *s = solvers[0];
+    std::deque<std::vector<Lit> > todo(1), ready; // Splits the shortest cubes first
+    vec<Lit> cube;
+    Var x;
+
+    while(s->okay() && !todo.empty() && (int) (todo.size() + ready.size()) < nbsolvers * cubes_by_thread) {
+        cube.clear();
+        for(Lit p : todo.front()) cube.push(p);
+        todo.pop_front();
+        if(s->lookahead(cube, x, lookahead_candidates) == l_False) {
+            nbcubesrefuted++;
+            continue;
+        }
+        std::vector<Lit> c;
+        for(int k = 0; k < cube.size(); k++)
+            c.push_back(cube[k]);
+        if(x == var_Undef) { // All the variables are assigned
+            ready.push_back(c);
+            continue;
+        }
+        for(int sign = 0; sign < 2; sign++) {
+            todo.push_back(c);
+            todo.back().push_back(mkLit(x, sign));
         }
     }
+    if(!s->okay())
+        todo.assign(1, std::vector<Lit>()); // Let the threads find the contradiction
+    for(std::vector<Lit> &c : todo)
+        ready.push_back(c);
+
+    cubes.assign(nbsolvers, std::deque<std::vector<Lit> >());
+    for(size_t k = 0; k < ready.size(); k++) {
+        cubes[k % nbsolvers].push_back(ready[k]);
+        nbcubesleft++;
+    }
+    if(verb >= 1)
+        printf("c |  %d cubes generated by lookahead (%" PRIu64" refuted)                                                      |\n", nbcubesleft, nbcubesrefuted);
+    return nbcubesleft > 0;
+}
 
 
-    return result;
-    /*
-    for(int i=0;i<NBTHREADS;i++)
-      pthread_join(*threads[i],&status);
-    */
+void MultiSolvers::solveCubes(int i) {
+    ParallelSolver *s = solvers[i];
+    vec<Lit> cube;
+    Var x = var_Undef;
+
+    for(;;) {
+        {
+            std::unique_lock<std::mutex> lock(mcubes);
+            int from = -1;
+            ccubes.wait(lock, [&]() {
+                from = -1;
+                if(nbcubesleft == 0 || sharedcomp->jobFinished()) return true;
+                if(!cubes[i].empty()) return from = i, true;
+                size_t longest = 0;
+                for(int j = 0; j < nbsolvers; j++)
+                    if(cubes[j].size() > longest) from = j, longest = cubes[j].size();
+                return from >= 0;
+            });
+            if(from < 0)
+                break;
+            std::vector<Lit> &c = from == i ? cubes[i].back() : cubes[from].front(); // Thieves take the largest subproblems
+            cube.clear();
+            for(Lit p : c) cube.push(p);
+            if(from == i)
+                cubes[i].pop_back();
+            else
+                cubes[from].pop_front(), nbcubesstolen++;
+        }
 
-}
+        lbool status;
+        for(;;) {
+            s->setConfBudget(cube_budget);
+            status = s->solveLimited(cube, false);
+            if(status != l_Undef || sharedcomp->jobFinished())
+                break;
+            if(s->lookahead(cube, x, lookahead_candidates) == l_False) {
+                status = l_False;
+                break;
+            }
+            if(x != var_Undef)
+                break;
+        }
 
+        {
+            std::lock_guard<std::mutex> lock(mcubes);
+            if(status == l_Undef && !sharedcomp->jobFinished()) { // Too long: split it
+                cube.push(mkLit(x, true));
+                pushCube(i, cube);
+                cube.last() = mkLit(x, false);
+                pushCube(i, cube);
+                nbcubessplit++;
+            } else if(status == l_False)
+                nbcubesrefuted++;
+            if(--nbcubesleft == 0 && status == l_False && sharedcomp->IFinished(s)) // All the cubes are refuted
+                sharedcomp->jobStatus = l_False;
+        }
+        ccubes.notify_all();
+    }
+}
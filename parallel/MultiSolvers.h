@@ -50,6 +50,13 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #ifndef MultiSolvers_h
 #define MultiSolvers_h
 
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "parallel/ParallelSolver.h"
 
 namespace Glucose {
@@ -59,7 +66,7 @@ class MultiSolvers {
     friend class SolverConfiguration;
 
 public:
-  MultiSolvers(ParallelSolver *s);
+  MultiSolvers(ParallelSolver *s); // Takes the ownership of the solver which loads the formula
   MultiSolvers();
   ~MultiSolvers();
  
@@ -75,6 +82,7 @@ public:
   Var     newVar    (bool polarity = true, bool dvar = true); // Add a new variable with parameters specifying variable mode.
   bool    addClause (const vec<Lit>& ps);                           // Add a clause to the solver. NOTE! 'ps' may be shrunk by this method!
   bool    addClause_(      vec<Lit>& ps);       
+  bool    addConstraint(std::unique_ptr<Constraint>&& constr); // Add a non-clause constraint (cloned for each thread)
   
   bool    simplify     ();                        // Removes already satisfied clauses.
   
@@ -106,6 +114,17 @@ public:
 
   bool use_simplification;
 
+  // Cube-and-conquer instead of a portfolio: the formula is split into cubes by lookahead, which
+  // the threads solve as assumptions with a budget of conflicts, splitting again the cubes which
+  // exceed it. Each thread takes the last cube of its own queue; an idle thread steals the first
+  // cube (the shortest one) of the longest queue.
+  bool use_cubes;
+  int  cube_budget;          // Conflicts spent on a cube before it is split
+  int  cubes_by_thread;      // Number of initial cubes by thread
+  int  lookahead_candidates; // Variables tried by the lookahead to split a cube
+  uint64_t cubesSplit  () const { return nbcubessplit; }
+  uint64_t cubesRefuted() const { return nbcubesrefuted; }
+
   
  protected:
 	friend class ParallelSolver;
@@ -156,18 +175,25 @@ struct Stats {
    //ClauseAllocator     ca;
    SharedCompanion * sharedcomp;
 
-    void informEnd(lbool res);
     ParallelSolver* retrieveSolver(int i);
 
-    pthread_mutex_t m; // mutex for any high level sync between all threads (like reportf)
-    pthread_mutex_t mfinished; // mutex on which main process may wait for... As soon as one process finishes it release the mutex
-    pthread_cond_t cfinished; // condition variable that says that a thread has finished
+    bool generateCubes(); // false if all the initial cubes are refuted
+    void solveCubes(int i); // body of thread i in cube-and-conquer
+    void pushCube(int i, const vec<Lit>& cube); // 'mcubes' must be held
+
+    std::mutex mfinished; // protects 'nbfinished'
+    std::condition_variable cfinished; // notified when a thread has finished
+    int nbfinished; // number of solver threads which returned from 'solve()'
 	
     vec<ParallelSolver*> solvers; // set of plain solvers
     vec<SolverCompanion*> solvercompanions; // set of companion solvers
-    vec<pthread_t*> threads; // all threads of this process
-    vec<int> threadIndexOfSolver; // threadIndexOfSolver[solvers[i]] is the index in threads[] of the solver i
-    vec<int> threadIndexOfSolverCompanion; // threadIndexOfSolverCompanion[solvercompanions[i]] is the index in threads[] of the solvercompanion i
+    std::vector<std::thread> threads; // all threads of this process (threads[i] runs solvers[i])
+
+    std::mutex mcubes; // protects the cubes and their stats
+    std::condition_variable ccubes; // notified when cubes are added, or none is left
+    std::vector<std::deque<std::vector<Lit> > > cubes; // cubes[i]: cubes queued for thread i
+    int nbcubesleft; // cubes queued or being solved (0 when all are refuted)
+    uint64_t nbcubessplit, nbcubesrefuted, nbcubesstolen;
 };
 
 inline bool     MultiSolvers::addClause       (const vec<Lit>& ps)    { ps.copyTo(add_tmp); return addClause_(add_tmp); }
@@ -47,6 +47,10 @@ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
 OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  **************************************************************************************************/
 
+#include <algorithm>
+#include <functional>
+#include <vector>
+
 #include "parallel/ParallelSolver.h"
 #include "mtl/Sort.h"
 
@@ -60,6 +64,9 @@ const char* _parallel = "PARALLEL";
 
 extern BoolOption opt_dontExportDirectReusedClauses; // (_cunstable, "reusedClauses",    "Don't export directly reused clauses", false);
 extern BoolOption opt_plingeling; // (_cunstable, "plingeling",    "plingeling strategy for sharing clauses (exploratory feature)", false);
+extern IntOption  opt_shareFilterSize; // (_parallel, "sharefilter", "log2 of the number of shared clauses remembered to filter duplicates", 20);
+
+static int localFilterSize() { return opt_shareFilterSize > 4 ? opt_shareFilterSize - 4 : opt_shareFilterSize; }
 
 //=====================================================================
 
@@ -82,8 +89,10 @@ ParallelSolver::ParallelSolver(int threadId) :
 , dontExportDirectReusedClauses(opt_dontExportDirectReusedClauses)
 , nbNotExportedBecauseDirectlyReused(0)
 {
-    useUnaryWatched = true; // We want to use promoted clauses here !
+    useUnaryWatched = false; // The core solver does not propagate unary watches: imported clauses are attached as learnts
+    use_inprocessing = false; // Eliminating variables in one thread would make the clauses it imports unsound
     stats.growTo(parallelStatsSize,0);
+    seenClauses.init(localFilterSize());
 }
 
 
@@ -114,6 +123,7 @@ ParallelSolver::ParallelSolver(const ParallelSolver &s) :
     useUnaryWatched = s.useUnaryWatched;
     s.stats.copyTo(stats);
     s.elimclauses.copyTo(elimclauses); // This should be done more efficiently some day
+    seenClauses.init(localFilterSize());
 }
 
 
@@ -288,9 +298,18 @@ void ParallelSolver::reportProgressArrayImports(vec<unsigned int> &totalColumns)
 |________________________________________________________________________________________________@*/
 
 bool ParallelSolver::shareClause(Clause & c) {
+    uint64_t h = ClauseFilter::hash(c, hashedClause);
+    if (seenClauses.enabled())
+        seenClauses.insert(h); // Do not import it back from another thread
+    if (sharedcomp->recentlyShared(h)) {
+        stats[nbNotExportedDuplicates]++;
+        return false;
+    }
     bool sent = sharedcomp->addLearnt(this, c);
-    if (sent)
+    if (sent) {
+        sharedcomp->clauseShared(h);
         stats[nbexported]++;
+    }
     return sent;
 }
 
@@ -346,6 +365,14 @@ bool ParallelSolver::parallelImportClauses() {
         if (importedClause.size() == 0)
             return true;
 
+        bool satisfied = false;
+        for (int i = 0; i < importedClause.size() && !satisfied; i++)
+            satisfied = value(importedClause[i]) == l_True;
+        if (satisfied || (seenClauses.enabled() && !seenClauses.insert(ClauseFilter::hash(importedClause, hashedClause)))) {
+            stats[nbNotImported]++;
+            continue;
+        }
+
         //printf("Thread %d imports clause from thread %d\n", threadNumber(), importedFromThread);
         CRef cr = ca.alloc(importedClause, true, true);
         ca[cr].setLBD(importedClause.size());
@@ -457,12 +484,11 @@ lbool ParallelSolver::solve_(bool do_simp, bool turn_off_simp) {
 
     model.clear();
     conflict.clear();
-    if (!ok) return l_False;
 
     solves++;
 
 
-    lbool status = l_Undef;
+    lbool status = ok ? l_Undef : l_False; // Even then, tell the other threads to stop
 
     // Search:
     int curr_restarts = 0;
@@ -482,8 +508,9 @@ lbool ParallelSolver::solve_(bool do_simp, bool turn_off_simp) {
             setFrozen(extra_frozen[i], false);
 */
     
+    // Under assumptions (a cube), l_False only refutes the assumptions in 'conflict'
     bool firstToFinish = false;
-    if (status != l_Undef)
+    if (status == l_True || (status == l_False && conflict.size() == 0))
         firstToFinish = sharedcomp->IFinished(this);
     if (firstToFinish) {
         printf("c Thread %d is 100%% pure glucose! First thread to finish! (%s answer).\n", threadNumber(), status == l_True ? "SAT" : status == l_False ? "UNSAT" : "UNKOWN");
@@ -491,21 +518,86 @@ lbool ParallelSolver::solve_(bool do_simp, bool turn_off_simp) {
     }
     
     if (firstToFinish && status == l_True) {
-        extendModel();
-
-
-        // Extend & copy model:
+        // Copy & extend model:
         model.growTo(nVars());
         for (int i = 0; i < nVars(); i++) model[i] = value(i);
+        extendModel();
     } else if (status == l_False && conflict.size() == 0)
         ok = false;
 
+    cancelUntil(0);
 
-    pthread_cond_signal(pcfinished);
 
-    //cancelUntil(0);
+    return status;
 
+}
 
-    return status;
 
+/*_________________________________________________________________________________________________
+|
+|  lookahead : (vec<Lit>& cube, Var& best, int candidates)   ->  [lbool]
+|  
+|  Description:
+|  Chooses the variable on which to split a cube: the candidates (the most active variables, then
+|  those with the most watches) are propagated both ways under the cube, and the best variable
+|  maximizes the product of the numbers of implied literals.
+|  Output: l_False if the cube is refuted by propagation, l_Undef otherwise
+|  @see MultiSolvers::solveCubes
+|________________________________________________________________________________________________@*/
+
+lbool ParallelSolver::lookahead(vec<Lit>& cube, Var& best, int candidates) {
+    assert(decisionLevel() == 0);
+    best = var_Undef;
+
+    for (int i = 0; i < cube.size(); i++) {
+        if (value(cube[i]) == l_True) continue;
+        if (value(cube[i]) == l_False) { cancelUntil(0); return l_False; }
+        newDecisionLevel();
+        uncheckedEnqueue(cube[i]);
+        if (hasConflict(propagate())) { cancelUntil(0); return l_False; }
+    }
+
+    std::vector<std::pair<std::pair<double, int>, Var> > cands;
+    for (Var v = 0; v < nVars(); v++)
+        if (value(v) == l_Undef && decision[v] && !isEliminated(v)) {
+            int occurs = watches[mkLit(v)].size() + watches[~mkLit(v)].size() + watchesBin[mkLit(v)].size() + watchesBin[~mkLit(v)].size();
+            cands.push_back(std::make_pair(std::make_pair(activity[v], occurs), v));
+        }
+    if ((int)cands.size() > candidates) {
+        std::partial_sort(cands.begin(), cands.begin() + candidates, cands.end(), std::greater<std::pair<std::pair<double, int>, Var> >());
+        cands.resize(candidates);
+    }
+
+    uint64_t bestScore = 0;
+    for (size_t i = 0; i < cands.size(); i++) {
+        Var v = cands[i].second;
+        if (value(v) != l_Undef) continue;
+        int  implied[2];
+        bool failed[2];
+        for (int s = 0; s < 2; s++) {
+            int before = trail.size();
+            newDecisionLevel();
+            uncheckedEnqueue(mkLit(v, s));
+            failed[s] = hasConflict(propagate());
+            implied[s] = trail.size() - before;
+            cancelUntil(decisionLevel() - 1);
+        }
+        if (failed[0] && failed[1]) { cancelUntil(0); return l_False; }
+        if (failed[0] || failed[1]) { // A failed literal: the cube implies its negation
+            Lit p = mkLit(v, failed[0]);
+            cube.push(p);
+            newDecisionLevel();
+            uncheckedEnqueue(p);
+            if (hasConflict(propagate())) { cancelUntil(0); return l_False; }
+            continue;
+        }
+        uint64_t score = (uint64_t)implied[0] * implied[1];
+        if (score > bestScore) best = v, bestScore = score;
+    }
+
+    for (Var v = 0; best == var_Undef && v < nVars(); v++) // All the candidates were failed literals
+        if (value(v) == l_Undef && decision[v] && !isEliminated(v))
+            best = v;
+    cancelUntil(0);
+    return l_Undef;
 }
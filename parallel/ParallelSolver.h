@@ -54,6 +54,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "core/Solver.h"
 #include "simp/SimpSolver.h"
 #include "parallel/SharedCompanion.h"
+#include "parallel/ClauseFilter.h"
 namespace Glucose {
     
    enum ParallelStats{
@@ -62,9 +63,11 @@ namespace Glucose {
        nbexportedunit,
        nbimportedunit,
        nbimportedInPurgatory,
-       nbImportedGoodClauses
+       nbImportedGoodClauses,
+       nbNotExportedDuplicates, // Recently shared by another thread
+       nbNotImported            // Recently learnt or imported, or satisfied at level 0
    } ;
-#define parallelStatsSize (coreStatsSize + 6)
+#define parallelStatsSize (coreStatsSize + 8)
  
 //=================================================================================================
     //class MultiSolvers;
@@ -85,8 +88,6 @@ protected :
     SharedCompanion *sharedcomp;
     bool coreFUIP; // true if one core is specialized for branching on all FUIP
     bool ImTheSolverFUIP;
-    pthread_mutex_t *pmfinished; // mutex on which main process may wait for... As soon as one process finishes it release the mutex
-    pthread_cond_t *pcfinished; // condition variable that says that a thread as finished
 
 public:
     // Constructor/Destructor:
@@ -110,12 +111,14 @@ public:
     virtual lbool         solve_                   (bool do_simp = true, bool turn_off_simp = false);
 
     vec<Lit>    importedClause; // Temporary clause used to copy each imported clause
+    vec<Lit>    hashedClause;   // Temporary clause used to hash a clause
+    ClauseFilter seenClauses;   // Hashes of the clauses recently shared or imported by this thread
     unsigned int    goodlimitlbd; // LBD score of the "good" clauses, locally
     int    goodlimitsize;
     bool purgatory; // mode of operation
     bool shareAfterProbation; // Share any none glue clause only after probation (seen 2 times in conflict analysis)
     bool plingeling; // plingeling strategy for sharing clauses (experimental)
-    int nbTimesSeenBeforeExport;
+    unsigned int nbTimesSeenBeforeExport;
     // Stats front end
 //    uint64_t   getNbExported() { return nbexported;}
  //   uint64_t   getNbImported() { return nbimported;}
@@ -140,6 +143,12 @@ public:
  
     bool shareClause(Clause & c); // true if the clause was succesfully sent
 
+    // Cube-and-conquer: chooses the variable 'best' on which to split 'cube' (var_Undef if all the
+    // variables are assigned), among 'candidates' variables propagated both ways under the cube.
+    // The literals implied by failed literals are added to the cube. Returns l_False if the cube
+    // is refuted by propagation, l_Undef otherwise. Must be called at level 0.
+    lbool lookahead(vec<Lit>& cube, Var& best, int candidates);
+
     
 
 };
@@ -56,18 +56,17 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 using namespace Glucose;
 
+extern IntOption opt_shareFilterSize;
+
 SharedCompanion::SharedCompanion(int _nbThreads) :
     nbThreads(_nbThreads), 
     bjobFinished(false),
     jobFinishedBy(NULL),
     panicMode(false), // The bug in the SAT2014 competition :)
     jobStatus(l_Undef),
+    nbUnits(0),
     random_seed(9164825) {
 
-	pthread_mutex_init(&mutexSharedClauseCompanion,NULL); // This is the shared companion lock
-	pthread_mutex_init(&mutexSharedUnitCompanion,NULL); // This is the shared companion lock
-	pthread_mutex_init(&mutexSharedCompanion,NULL); // This is the shared companion lock
-	pthread_mutex_init(&mutexJobFinished,NULL); // This is the shared companion lock
 	if (_nbThreads> 0)  {
 	    setNbThreads(_nbThreads);
 	    fprintf(stdout,"c Shared companion initialized: handling of clauses of %d threads.\nc %d ints for the sharing clause buffer (not expandable) .\n", _nbThreads, clausesBuffer.maxSize());
@@ -78,6 +77,7 @@ SharedCompanion::SharedCompanion(int _nbThreads) :
 void SharedCompanion::setNbThreads(int _nbThreads) {
    nbThreads = _nbThreads;
    clausesBuffer.setNbThreads(_nbThreads); 
+   sharedClauses.init(opt_shareFilterSize);
 }
 
 void SharedCompanion::printStats() {
@@ -86,35 +86,33 @@ void SharedCompanion::printStats() {
 // No multithread safe
 bool SharedCompanion::addSolver(ParallelSolver* s) {
 	watchedSolvers.push(s);
-	pthread_mutex_t* mu = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
-	pthread_mutex_init(mu,NULL);
 	assert(s->thn == watchedSolvers.size()-1); // all solvers must have been registered in the good order
-	nextUnit.push(0);
+	nextUnit.emplace_back();
 
 	return true;
 }
 void SharedCompanion::newVar(bool sign) {
-   isUnary .push(l_Undef);
+   isUnary.emplace_back(false);
+   unitLit.emplace_back(toInt(lit_Undef));
 }
 
 void SharedCompanion::addLearnt(ParallelSolver *s,Lit unary) {
-  pthread_mutex_lock(&mutexSharedUnitCompanion);
-  if (isUnary[var(unary)]==l_Undef) {
-      unitLit.push(unary);
-      isUnary[var(unary)] = sign(unary)?l_False:l_True;
-  } 
-  pthread_mutex_unlock(&mutexSharedUnitCompanion);
+  bool shared = false;
+  if (isUnary[var(unary)].compare_exchange_strong(shared, true)) {
+      int slot = nbUnits.fetch_add(1, std::memory_order_relaxed);
+      unitLit[slot].store(toInt(unary), std::memory_order_release);
+  }
 }
 
 Lit SharedCompanion::getUnary(ParallelSolver *s) {
-  int sn = s->thn;
-  Lit ret = lit_Undef;
-
-  pthread_mutex_lock(&mutexSharedUnitCompanion);
-  if (nextUnit[sn] < unitLit.size())
-      ret = unitLit[nextUnit[sn]++];
-  pthread_mutex_unlock(&mutexSharedUnitCompanion);
- return ret;
+  int & next = nextUnit[s->thn].next;
+  if (next == (int)unitLit.size())
+      return lit_Undef;
+  int x = unitLit[next].load(std::memory_order_acquire);
+  if (x == toInt(lit_Undef))
+      return lit_Undef; // Not written yet
+  next++;
+  return toLit(x);
 }
 
 // Specialized functions for this companion
@@ -122,45 +120,41 @@ Lit SharedCompanion::getUnary(ParallelSolver *s) {
 // Add a clause to the threads-wide clause database (all clauses, through)
 bool SharedCompanion::addLearnt(ParallelSolver *s, Clause & c) { 
   int sn = s->thn; // thread number of the solver
-  bool ret = false;
   assert(watchedSolvers.size()>sn);
 
-  pthread_mutex_lock(&mutexSharedClauseCompanion);
-  ret = clausesBuffer.pushClause(sn, c);
-  pthread_mutex_unlock(&mutexSharedClauseCompanion);
-  return ret;
+  return clausesBuffer.pushClause(sn, c);
+}
+
+
+// Filters the clauses learnt by several threads: the first one to share it puts it on the blackboard.
+// A clause is only remembered once it is there, so that a failed push does not filter it out.
+bool SharedCompanion::recentlyShared(uint64_t hash) const {
+  return sharedClauses.enabled() && sharedClauses.contains(hash);
+}
+
+
+void SharedCompanion::clauseShared(uint64_t hash) {
+  if(sharedClauses.enabled())
+    sharedClauses.insert(hash);
 }
 
 
 bool SharedCompanion::getNewClause(ParallelSolver *s, int & threadOrigin, vec<Lit>& newclause) { // gets a new interesting clause for solver s 
   int sn = s->thn;
-  
-    // First, let's get the clauses on the big blackboard
-    pthread_mutex_lock(&mutexSharedClauseCompanion);
-    bool b = clausesBuffer.getClause(sn, threadOrigin, newclause);
-    pthread_mutex_unlock(&mutexSharedClauseCompanion);
- 
-  return b;
+
+  return clausesBuffer.getClause(sn, threadOrigin, newclause);
 }
 
 bool SharedCompanion::jobFinished() {
-    bool ret = false;
-    pthread_mutex_lock(&mutexJobFinished);
-    ret = bjobFinished;
-    pthread_mutex_unlock(&mutexJobFinished);
-    return ret;
+    return bjobFinished.load(std::memory_order_relaxed);
 }
 
 bool SharedCompanion::IFinished(ParallelSolver *s) {
-    bool ret = false;
-    pthread_mutex_lock(&mutexJobFinished);
-    if (!bjobFinished) {
-	ret = true;
-	bjobFinished = true;
-	jobFinishedBy = s;
-    }
-    pthread_mutex_unlock(&mutexJobFinished);
-    return ret;
+    bool expected = false;
+    if (!bjobFinished.compare_exchange_strong(expected, true))
+	return false;
+    jobFinishedBy = s;
+    return true;
 }
 
 
@@ -47,7 +47,7 @@ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
 OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  **************************************************************************************************/
 
-/* This class is responsible for protecting (by mutex) information exchange between threads.
+/* This class is responsible for the (lock-free) information exchange between threads.
  * It also allows each solver to send / receive clause / unary clauses.
  *
  * Only one sharedCompanion is created for all the solvers
@@ -56,10 +56,15 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #ifndef SharedCompanion_h
 #define SharedCompanion_h
+#include <atomic>
+#include <deque>
+#include <vector>
+
 #include "core/SolverTypes.h"
 #include "parallel/ParallelSolver.h"
 #include "parallel/SolverCompanion.h"
 #include "parallel/ClausesBuffer.h"
+#include "parallel/ClauseFilter.h"
 
 namespace Glucose {
 
@@ -78,6 +83,8 @@ public:
 	bool addSolver(ParallelSolver*);   // attach a solver to accompany 
 	void addLearnt(ParallelSolver *s,Lit unary);   // Add a unary clause to share
 	bool addLearnt(ParallelSolver *s, Clause & c); // Add a clause to the shared companion, as a database manager
+	bool recentlyShared(uint64_t hash) const;      // True if the clause was shared recently
+	void clauseShared(uint64_t hash);              // Remembers a clause put on the blackboard
 
 	bool getNewClause(ParallelSolver *s, int &th, vec<Lit> & nc); // gets a new interesting clause for solver s 
 	Lit getUnary(ParallelSolver *s);                              // Gets a new unary literal
@@ -86,24 +93,23 @@ public:
  protected:
 
 	ClausesBuffer clausesBuffer; // A big blackboard for all threads sharing non unary clauses
+	ClauseFilter  sharedClauses; // Hashes of the clauses recently put on the blackboard
 	int nbThreads;               // Number of threads
-	
-	// A set of mutex variables
-	pthread_mutex_t mutexSharedCompanion; // mutex for any high level sync between all threads (like reportf)
-	pthread_mutex_t mutexSharedClauseCompanion; // mutex for reading/writing clauses on the blackboard
-	pthread_mutex_t mutexSharedUnitCompanion; // mutex for reading/writing unit clauses on the blackboard 
-        pthread_mutex_t mutexJobFinished;
-
-	bool bjobFinished;
-	ParallelSolver *jobFinishedBy;
-	bool panicMode;                        // panicMode means no more increasing space needed
+
+	std::atomic<bool> bjobFinished;        // Polled by all the solvers, set once by the first one to finish
+	ParallelSolver *jobFinishedBy;         // Only written by the solver which sets 'bjobFinished'
+	std::atomic<bool> panicMode;           // panicMode means no more increasing space needed
 	lbool jobStatus;                       // globale status of the job
 
         // Shared clauses are a queue of lits...
 	//	friend class wholearnt;
-	vec<int> nextUnit; // indice of next unit clause to retrieve for solver number i 
-	vec<Lit> unitLit;  // Set of unit literals found so far
-        vec<lbool> isUnary; // sign of the unary var (if proved, or l_Undef if not)	
+	// Unit clauses: the first solver to share a unit on a variable takes the next slot of 'unitLit'
+	// (one per variable at most), which readers see once the literal is written.
+	struct alignas(64) UnitCursor { int next = 0; };
+	std::vector<UnitCursor> nextUnit;     // indice of next unit clause to retrieve for solver number i
+	std::deque<std::atomic<int>> unitLit; // Set of unit literals found so far, then lit_Undef
+	std::atomic<int> nbUnits;             // Number of slots of 'unitLit' taken
+	std::deque<std::atomic<bool>> isUnary; // true if a unit was shared on the var
 	double    random_seed;
 
 	// Returns a random float 0 <= x < 1. Seed must never be 0.
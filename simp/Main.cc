@@ -51,19 +51,17 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include <signal.h>
 
-#ifdef USE_ZLIB
-#include <zlib.h>
-#else
-#include <utils/fake_zlib.h>
-#endif
-
 #include <sys/resource.h>
 
 #include "utils/System.h"
 #include "utils/ParseUtils.h"
 #include "utils/Options.h"
 #include "core/Dimacs.h"
+#include "core/BinaryCNF.h"
 #include "simp/SimpSolver.h"
+#include "constraints/AtMost.h"
+#include "constraints/EncodingDetection.h"
+#include "constraints/Xor.h"
 
 using namespace Glucose;
 
@@ -85,6 +83,16 @@ void printStats(Solver& solver)
     printf("c nb learnts size 1     : %" PRIu64"\n", solver.stats[nbUn]);
     if(solver.chanseokStrategy)
         printf("c nb permanent learnts  : %" PRIu64"\n", solver.stats[nbPermanentLearnts]);
+    if(solver.chrono >= 0)
+        printf("c chrono backtracks     : %" PRIu64" (non chrono: %" PRIu64")\n", solver.stats[nbChronoBT], solver.stats[nbNonChronoBT]);
+    if(solver.trail_saving)
+        printf("c replayed propagations : %" PRIu64"\n", solver.stats[nbTrailReplayed]);
+    if(solver.stable_mode_switching)
+        printf("c mode switches         : %" PRIu64" (rephases: %" PRIu64")\n", solver.stats[nbModeSwitches], solver.stats[nbRephases]);
+    if(solver.vivify)
+        printf("c vivified clauses      : %" PRIu64" (removed literals: %" PRIu64")\n", solver.stats[nbVivifiedClauses], solver.stats[nbVivifiedLits]);
+    if(solver.probing)
+        printf("c probed variables      : %" PRIu64" (units: %" PRIu64", hyper-binaries: %" PRIu64")\n", solver.stats[nbProbes], solver.stats[nbProbeUnits], solver.stats[nbHyperBinaries]);
 
     printf("c conflicts             : %-12" PRIu64"   (%.0f /sec)\n", solver.conflicts   , solver.conflicts   /cpu_time);
     printf("c decisions             : %-12" PRIu64"   (%4.2f %% random) (%.0f /sec)\n", solver.decisions, (float)solver.stats[rnd_decisions]*100 / (float)solver.decisions, solver.decisions   /cpu_time);
@@ -124,7 +132,7 @@ int main(int argc, char** argv)
       printf("c\nc This is glucose 4.0 --  based on MiniSAT (Many thanks to MiniSAT team)\nc\n");
 
 
-      setUsageHelp("c USAGE: %s [options] <input-file> <result-output-file>\n\n  where input may be either in plain or gzipped DIMACS.\n");
+      setUsageHelp("c USAGE: %s [options] <input-file> <result-output-file>\n\n  where input may be either in plain, gzipped or xz-compressed DIMACS, or in binary CNF format.\n");
 
 
 #if defined(__linux__)
@@ -139,13 +147,20 @@ int main(int argc, char** argv)
         IntOption    vv  ("MAIN", "vv",   "Verbosity every vv conflicts", 10000, IntRange(1,INT32_MAX));
         BoolOption   pre    ("MAIN", "pre",    "Completely turn on/off any preprocessing.", true);
         StringOption dimacs ("MAIN", "dimacs", "If given, stop after preprocessing and write the result to this file.");
+        StringOption dump_bin("MAIN", "dump-bin", "If given, stop after parsing and write the problem to this file in binary CNF format.");
         IntOption    cpu_lim("MAIN", "cpu-lim","Limit on CPU time allowed in seconds.\n", INT32_MAX, IntRange(0, INT32_MAX));
         IntOption    mem_lim("MAIN", "mem-lim","Limit on memory usage in megabytes.\n", INT32_MAX, IntRange(0, INT32_MAX));
+        BoolOption   detect ("MAIN", "detect", "Detect at-most-one and XOR constraints encoded by clauses.", false);
+        IntOption    detect_xor("MAIN", "detect-xor", "Maximal size of the XOR constraints detected.", 6, IntRange(0, 20));
+        IntOption    detect_amo("MAIN", "detect-amo", "Minimal size of the at-most-one constraints detected.", 3, IntRange(2, INT32_MAX));
+        IntOption    parse_threads("MAIN", "parse-threads", "Number of threads parsing a plain input file.", 1, IntRange(1, 256));
+        BoolOption   parse_ordered("MAIN", "parse-ordered", "Add the clauses in the order of the input when parsing with several threads.", true);
  //       BoolOption opt_incremental ("MAIN","incremental", "Use incremental SAT solving",false);
 
          BoolOption    opt_certified      (_certified, "certified",    "Certified UNSAT using DRUP format", false);
          StringOption  opt_certified_file      (_certified, "certified-output",    "Certified UNSAT output file", "NULL");
          BoolOption    opt_vbyte             (_certified, "vbyte",    "Emit proof in variable-byte encoding", false);
+         BoolOption    opt_lrat              (_certified, "lrat",     "Emit proof in LRAT format (disables preprocessing, inprocessing, vivification, probing and chronological backtracking)", false);
 
         parseOptions(argc, argv, true);
 
@@ -163,17 +178,22 @@ int main(int argc, char** argv)
 
         S.certifiedUNSAT = opt_certified;
         S.vbyte = opt_vbyte;
+        if(S.certifiedUNSAT && opt_lrat) {
+            if (dump_bin)
+                printf("ERROR! LRAT proofs cannot be used with binary CNF files.\n"), exit(1);
+            S.useLRAT();
+        }
         if(S.certifiedUNSAT) {
             if(!strcmp(opt_certified_file,"NULL")) {
                 S.vbyte =  false;  // Cannot write binary to stdout
                 S.certifiedOutput =  fopen("/dev/stdout", "wb");
                 if(S.verbosity >= 1)
-                    printf("c\nc Write unsat proof on stdout using text format\nc\n");
+                    printf("c\nc Write unsat proof on stdout using text %s format\nc\n", S.lrat ? "LRAT" : "DRAT");
             } else
                 S.certifiedOutput =  fopen(opt_certified_file, "wb");
                 const char *name = opt_certified_file;
                 if(S.verbosity >= 1)
-                    printf("c\nc Write unsat proof on %s using %s format\nc\n",name,S.vbyte ? "binary" : "text");
+                    printf("c\nc Write unsat proof on %s using %s %s format\nc\n",name,S.vbyte ? "binary" : "text",S.lrat ? "LRAT" : "DRAT");
         }
 
         solver = &S;
@@ -207,8 +227,8 @@ int main(int argc, char** argv)
         if (argc == 1)
             printf("c Reading from standard input... Use '--help' for help.\n");
 
-        gzFile in = (argc == 1) ? gzdopen(0, "rb") : gzopen(argv[1], "rb");
-        if (in == NULL)
+        InputFile in((argc == 1) ? NULL : argv[1]);
+        if (!in.isOpen())
             printf("ERROR! Could not open file: %s\n", argc == 1 ? "<stdin>" : argv[1]), exit(1);
 
       if (S.verbosity > 0){
@@ -216,8 +236,47 @@ int main(int argc, char** argv)
             printf("c |                                                                                                       |\n"); }
 
         FILE* res = (argc >= 3) ? fopen(argv[argc-1], "wb") : NULL;
-        parse_DIMACS(in, S);
-        gzclose(in);
+        std::vector<BinaryConstraint> native;  // Non-clausal constraints of the problem
+        if (isBinaryCNF(in)){
+            if (S.lrat)
+                printf("ERROR! LRAT proofs cannot be used with binary CNF files.\n"), exit(1);
+            loadBinaryCNF(in, S, native);
+            if (!native.empty() && (S.certifiedUNSAT || dimacs))
+                printf("ERROR! Native constraints cannot be written to proofs or DIMACS files.\n"), exit(1);
+        }
+        // Native constraints are not written to DIMACS files. In DRAT proofs, the explanations of
+        // the detected constraints follow from their encodings in the input. LRAT proofs have no
+        // explanations:
+        else if (detect && !dimacs && !S.lrat){
+            ClauseCollector clauses;
+            parse_DIMACS_parallel(in, clauses, parse_threads, parse_ordered);
+            DetectedEncodings found = DetectEncodings(clauses.nVars(), clauses.clauses, detect_xor, detect_amo);
+
+            while (S.nVars() < clauses.nVars()) S.newVar();
+            vec<Lit> lits;
+            for (const std::vector<Lit>& c : clauses.clauses){
+                lits.clear();
+                for (Lit l : c) lits.push(l);
+                S.addClause_(lits); }
+            for (std::vector<Lit>& amo : found.at_most_ones)
+                native.push_back({BinaryConstraint::AtMost, 1, std::move(amo)});
+            for (auto& [xor_lits, parity] : found.xors)
+                native.push_back({BinaryConstraint::Xor, parity, std::move(xor_lits)});
+
+            if (S.verbosity > 0){
+                printf("c |  Detected at-most-one: %12d                                                                   |\n", (int)found.at_most_ones.size());
+                printf("c |  Detected XOR:         %12d                                                                   |\n", (int)found.xors.size());
+                printf("c |  Removed clauses:      %12d                                                                   |\n", found.n_removed_clauses); }
+        }else
+            // LRAT proofs refer to the input clauses by their position
+            parse_DIMACS_parallel(in, S, parse_threads, parse_ordered || S.lrat);
+
+        // Only detected constraints remain with proofs
+        for (BinaryConstraint& c : native)
+            if (c.type == BinaryConstraint::AtMost)
+                S.addConstraint(std::make_unique<AtMost>(std::vector<Lit>(c.lits), c.param), true);
+            else
+                S.addConstraint(std::make_unique<Xor>(c.lits, c.param), true);
 
        if (S.verbosity > 0){
             printf("c |  Number of variables:  %12d                                                                   |\n", S.nVars());
@@ -228,6 +287,10 @@ int main(int argc, char** argv)
             printf("c |  Parse time:           %12.2f s                                                                 |\n", parsed_time - initial_time);
             printf("c |                                                                                                       |\n"); }
 
+        if (dump_bin){
+            S.toBinary((const char*)dump_bin, native);
+            exit(0); }
+
         // Change to signal-handlers that will only notify the solver and allow it to terminate
         // voluntarily:
         signal(SIGINT, SIGINT_interrupt);
@@ -244,7 +307,7 @@ int main(int argc, char** argv)
 	}
 	printf("c |                                                                                                       |\n");
         if (!S.okay()){
-            if (S.certifiedUNSAT) fprintf(S.certifiedOutput, "0\n"), fclose(S.certifiedOutput);
+            if (S.certifiedUNSAT) S.closeProof(true);
             if (res != NULL) fprintf(res, "UNSAT\n"), fclose(res);
             if (S.verbosity > 0){
  	        printf("c =========================================================================================================\n");
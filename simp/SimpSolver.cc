@@ -47,6 +47,12 @@ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
 OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  **************************************************************************************************/
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "mtl/Sort.h"
 #include "simp/SimpSolver.h"
 #include "utils/System.h"
@@ -62,10 +68,16 @@ static const char* _cat = "SIMP";
 BOOL_OPTION(opt_use_asymm, _cat, "asymm",        "Shrink clauses by asymmetric branching.", false);
 BOOL_OPTION(opt_use_rcheck, _cat, "rcheck",       "Check if a clause is already implied. (costly)", false);
 BOOL_OPTION(opt_use_elim, _cat, "elim",         "Perform variable elimination.", true);
+INT_OPTION(opt_elim_threads, _cat, "elim-threads", "Number of threads deciding variable eliminations (1 means sequential).", 1, IntRange(1, 256));
+BOOL_OPTION(opt_use_subst, _cat, "subst",        "Substitute equivalent literals (strongly connected components of binary clauses).", true);
 INT_OPTION(opt_grow, _cat, "grow",         "Allow a variable elimination step to grow by a number of clauses.", 0, IntRange(INT32_MIN, INT32_MAX));
 INT_OPTION(opt_clause_lim, _cat, "cl-lim",       "Variables are not eliminated if it produces a resolvent with a length above this limit. -1 means no limit", 20,   IntRange(-1, INT32_MAX));
 INT_OPTION(opt_subsumption_lim, _cat, "sub-lim",      "Do not check if subsumption against a clause larger than this. -1 means no limit.", 1000, IntRange(-1, INT32_MAX));
 DOUBLE_OPTION(opt_simp_garbage_frac, _cat, "simp-gc-frac", "The fraction of wasted memory allowed before a garbage collection is triggered during simplification.",  0.5, DoubleRange(0, false, HUGE_VAL, false));
+BOOL_OPTION(opt_use_inprocessing, _cat, "inprocess",    "Perform rounds of subsumption and variable elimination during search.", false);
+INT_OPTION(opt_inprocess_int, _cat, "inprocess-int", "The number of conflicts between inprocessing rounds.", 30000, IntRange(1, INT32_MAX));
+INT_OPTION(opt_inprocess_units, _cat, "inprocess-units", "The number of new top-level units triggering an inprocessing round (0 means ignored).", 100, IntRange(0, INT32_MAX));
+INT_OPTION(opt_inprocess_effort, _cat, "inprocess-effort", "Resolution and subsumption steps allowed per inprocessing round.", 20000000, IntRange(0, INT32_MAX));
 
 
 //=================================================================================================
@@ -81,15 +93,28 @@ SimpSolver::SimpSolver() :
   , use_asymm          (opt_use_asymm)
   , use_rcheck         (opt_use_rcheck)
   , use_elim           (opt_use_elim)
+  , elim_threads       (opt_elim_threads)
+  , use_subst          (opt_use_subst)
+  , use_inprocessing   (opt_use_inprocessing)
+  , inprocess_int      (opt_inprocess_int)
+  , inprocess_units    (opt_inprocess_units)
+  , inprocess_effort   (opt_inprocess_effort)
   , merges             (0)
   , asymm_lits         (0)
   , eliminated_vars    (0)
+  , substituted_vars   (0)
+  , inprocessings      (0)
+  , subsumed_learnts   (0)
   , use_simplification (true)
   , elimorder          (1)
   , occurs             (ClauseDeleted(ca))
   , elim_heap          (ElimLt(n_occ))
   , bwdsub_assigns     (0)
   , n_touched          (0)
+  , simp_steps         (0)
+  , simp_steps_limit   (-1)
+  , next_inprocess     (0)
+  , inprocess_trail    (0)
 {
     vec<Lit> dummy(1,lit_Undef);
     ca.extra_clause_field = true; // NOTE: must happen before allocating the dummy clause below.
@@ -112,15 +137,28 @@ SimpSolver::SimpSolver(const SimpSolver &s) : Solver(s)
   , use_asymm          (s.use_asymm)
   , use_rcheck         (s.use_rcheck)
   , use_elim           (s.use_elim)
+  , elim_threads       (s.elim_threads)
+  , use_subst          (s.use_subst)
+  , use_inprocessing   (s.use_inprocessing)
+  , inprocess_int      (s.inprocess_int)
+  , inprocess_units    (s.inprocess_units)
+  , inprocess_effort   (s.inprocess_effort)
   , merges             (s.merges)
   , asymm_lits         (s.asymm_lits)
   , eliminated_vars    (s.eliminated_vars)
+  , substituted_vars   (s.substituted_vars)
+  , inprocessings      (s.inprocessings)
+  , subsumed_learnts   (s.subsumed_learnts)
   , use_simplification (s.use_simplification)
   , elimorder          (s.elimorder)
   , occurs             (ClauseDeleted(ca))
   , elim_heap          (ElimLt(n_occ))
   , bwdsub_assigns     (s.bwdsub_assigns)
   , n_touched          (s.n_touched)
+  , simp_steps         (s.simp_steps)
+  , simp_steps_limit   (s.simp_steps_limit)
+  , next_inprocess     (s.next_inprocess)
+  , inprocess_trail    (s.inprocess_trail)
 {
     // TODO: Copy dummy... what is it???
     vec<Lit> dummy(1,lit_Undef);
@@ -138,6 +176,9 @@ SimpSolver::SimpSolver(const SimpSolver &s) : Solver(s)
     s.subsumption_queue.copyTo(subsumption_queue);
     s.frozen.memCopyTo(frozen);
     s.eliminated.memCopyTo(eliminated);
+    s.constrained.memCopyTo(constrained);
+    s.lit_mark.memCopyTo(lit_mark);
+    s.inprocess_occ.memCopyTo(inprocess_occ);
 
     use_simplification = s.use_simplification;
     bwdsub_assigns = s.bwdsub_assigns;
@@ -153,6 +194,9 @@ Var SimpSolver::newVar(bool sign, bool dvar) {
     Var v = Solver::newVar(sign, dvar);
     frozen    .push((char)false);
     eliminated.push((char)false);
+    constrained.push((char)0);
+    lit_mark  .push((char)0);
+    lit_mark  .push((char)0);
 
     if (use_simplification){
         n_occ     .push(0);
@@ -213,48 +257,99 @@ bool SimpSolver::addClause_(vec<Lit>& ps)
 #endif
     int nclauses = clauses.size();
 
-    if (use_rcheck && implied(ps))
-        return true;
+    if (use_rcheck && ok && implied(ps)){
+        if (certifiedUNSAT && lrat) proof_id++; // The dropped clause keeps its LRAT ID
+        return true; }
 
     if (!Solver::addClause_(ps))
         return false;
 
-    if(!parsing && certifiedUNSAT) {
-        if (vbyte) {
-            write_char('a');
-            for (int i = 0; i < ps.size(); i++)
-                write_lit(2*(var(ps[i])+1) + sign(ps[i]));
-            write_lit(0);
-        }
-        else {
-            for (int i = 0; i < ps.size(); i++)
-                fprintf(certifiedOutput, "%i " , (var(ps[i]) + 1) * (-2 * sign(ps[i]) + 1) );
-            fprintf(certifiedOutput, "0\n");
-        }
+    if(!parsing && !lrat)
+        writeProofClause(ps);
+
+    if (use_simplification && clauses.size() == nclauses + 1)
+        addOccurrences(clauses.last());
+
+    return true;
+}
+
+
+bool SimpSolver::addClauses(const Lit* lits, const uint32_t* offsets, int n_clauses)
+{
+    if (use_rcheck){
+        vec<Lit> ps;
+        for (int i = 0; i < n_clauses; i++){
+            ps.clear();
+            for (uint32_t k = offsets[i]; k < offsets[i+1]; k++)
+                ps.push(lits[k]);
+            if (!addClause_(ps) && !lrat) return false; }
+        return ok;
+    }
+
+    // The clauses are added by 'adoptClause()', after reserving their occurrences:
+    if (use_simplification && n_clauses >= nVars() / 4){
+        vec<int> n(nVars(), 0);
+        for (uint32_t k = offsets[0]; k < offsets[n_clauses]; k++)
+            n[var(lits[k])]++;
+        for (Var v = 0; v < nVars(); v++)
+            if (n[v] > 0) occurs[v].capacity(occurs[v].size() + n[v]);
     }
+    return Solver::addClauses(lits, offsets, n_clauses);
+}
 
-    if (use_simplification && clauses.size() == nclauses + 1){
-        CRef          cr = clauses.last();
-        const Clause& c  = ca[cr];
 
-        // NOTE: the clause is added to the queue immediately and then
-        // again during 'gatherTouchedClauses()'. If nothing happens
-        // in between, it will only be checked once. Otherwise, it may
-        // be checked twice unnecessarily. This is an unfortunate
-        // consequence of how backward subsumption is used to mimic
-        // forward subsumption.
-        subsumption_queue.insert(cr);
-        for (int i = 0; i < c.size(); i++){
-            occurs[var(c[i])].push(cr);
-            n_occ[toInt(c[i])]++;
-            touched[var(c[i])] = 1;
-            n_touched++;
-            if (elim_heap.inHeap(var(c[i])))
-                elim_heap.increase(var(c[i]));
-        }
+// Elimination, subsumption and substitution do not give LRAT hints:
+void SimpSolver::useLRAT()
+{
+    Solver::useLRAT();
+    use_simplification = false;
+    use_inprocessing   = false;
+}
+
+
+void SimpSolver::reserveVars(int n)
+{
+    Solver::reserveVars(n);
+    frozen     .capacity(n);
+    eliminated .capacity(n);
+    constrained.capacity(n);
+    lit_mark   .capacity(2 * n);
+    if (use_simplification){
+        n_occ    .capacity(2 * n);
+        occurs   .capacity(n);
+        touched  .capacity(n);
+        elim_heap.capacity(n);
     }
+}
 
-    return true;
+
+void SimpSolver::adoptClause(CRef cr)
+{
+    Solver::adoptClause(cr);
+    if (use_simplification)
+        addOccurrences(cr);
+}
+
+
+void SimpSolver::addOccurrences(CRef cr)
+{
+    const Clause& c = ca[cr];
+
+    // NOTE: the clause is added to the queue immediately and then
+    // again during 'gatherTouchedClauses()'. If nothing happens
+    // in between, it will only be checked once. Otherwise, it may
+    // be checked twice unnecessarily. This is an unfortunate
+    // consequence of how backward subsumption is used to mimic
+    // forward subsumption.
+    subsumption_queue.insert(cr);
+    for (int i = 0; i < c.size(); i++){
+        occurs[var(c[i])].push(cr);
+        n_occ[toInt(c[i])]++;
+        touched[var(c[i])] = 1;
+        n_touched++;
+        if (elim_heap.inHeap(var(c[i])))
+            elim_heap.increase(var(c[i]));
+    }
 }
 
 
@@ -263,6 +358,7 @@ void SimpSolver::removeClause(CRef cr,bool inPurgatory)
 {
     const Clause& c = ca[cr];
 
+    markBusy(c);
     if (use_simplification)
         for (int i = 0; i < c.size(); i++){
             n_occ[toInt(c[i])]--;
@@ -284,38 +380,14 @@ bool SimpSolver::strengthenClause(CRef cr, Lit l)
     // if (!find(subsumption_queue, &c))
     subsumption_queue.insert(cr);
 
-    if (certifiedUNSAT) {
-        if (vbyte) {
-            write_char('a');
-            for (int i = 0; i < c.size(); i++)
-                if (c[i] != l) write_lit(2*(var(c[i])+1) + sign(c[i]));
-            write_lit(0);
-        }
-        else {
-            for (int i = 0; i < c.size(); i++)
-                if (c[i] != l) fprintf(certifiedOutput, "%i " , (var(c[i]) + 1) * (-2 * sign(c[i]) + 1) );
-            fprintf(certifiedOutput, "0\n");
-        }
-    }
+    writeProofClause(c, false, l);
 
+    markBusy(c);
     if (c.size() == 2){
         removeClause(cr);
         c.strengthen(l);
     }else{
-        if (certifiedUNSAT) {
-            if (vbyte) {
-                write_char('d');
-                for (int i = 0; i < c.size(); i++)
-                    write_lit(2*(var(c[i])+1) + sign(c[i]));
-                write_lit(0);
-            }
-            else {
-                fprintf(certifiedOutput, "d ");
-                for (int i = 0; i < c.size(); i++)
-                    fprintf(certifiedOutput, "%i " , (var(c[i]) + 1) * (-2 * sign(c[i]) + 1) );
-                fprintf(certifiedOutput, "0\n");
-            }
-        }
+        writeProofClause(c, true);
 
         detachClause(cr, true);
         c.strengthen(l);
@@ -333,6 +405,7 @@ bool SimpSolver::strengthenClause(CRef cr, Lit l)
 bool SimpSolver::merge(const Clause& _ps, const Clause& _qs, Var v, vec<Lit>& out_clause)
 {
     merges++;
+    simp_steps++;
     out_clause.clear();
 
     bool  ps_smallest = _ps.size() < _qs.size();
@@ -361,10 +434,8 @@ bool SimpSolver::merge(const Clause& _ps, const Clause& _qs, Var v, vec<Lit>& ou
 
 
 // Returns FALSE if clause is always satisfied.
-bool SimpSolver::merge(const Clause& _ps, const Clause& _qs, Var v, int& size)
+bool SimpSolver::merge(const Clause& _ps, const Clause& _qs, Var v, int& size) const
 {
-    merges++;
-
     bool  ps_smallest = _ps.size() < _qs.size();
     const Clause& ps  =  ps_smallest ? _qs : _ps;
     const Clause& qs  =  ps_smallest ? _ps : _qs;
@@ -448,8 +519,8 @@ bool SimpSolver::backwardSubsumptionCheck(bool verbose)
 
     while (subsumption_queue.size() > 0 || bwdsub_assigns < trail.size()){
 
-        // Empty subsumption queue and return immediately on user-interrupt:
-        if (asynch_interrupt){
+        // Empty subsumption queue and return immediately on user-interrupt (or exhausted budget):
+        if (simpInterrupted()){
             subsumption_queue.clear();
             bwdsub_assigns = trail.size();
             break; }
@@ -480,32 +551,69 @@ bool SimpSolver::backwardSubsumptionCheck(bool verbose)
         // Search all candidates:
         vec<CRef>& _cs = occurs.lookup(best);
         CRef*       cs = (CRef*)_cs;
+        simp_steps += _cs.size();
 
+        uint64_t abst = c.abstraction();
+        int      size = c.size();
+        for (int i = 0; i < size; i++)
+            lit_mark[toInt(c[i])] = 1;
+
+        bool res = true;
         for (int j = 0; j < _cs.size(); j++)
             if (c.mark())
                 break;
             else if (!ca[cs[j]].mark() &&  cs[j] != cr && (subsumption_lim == -1 || ca[cs[j]].size() < subsumption_lim)){
-                Lit l = c.subsumes(ca[cs[j]]);
+                const Clause& d = ca[cs[j]];
+                if (d.size() < size || (abst & ~d.abstraction()) != 0)
+                    continue;
+                Lit l = subsumesMarked(size, d);
 
                 if (l == lit_Undef)
                     subsumed++, removeClause(cs[j]);
                 else if (l != lit_Error){
                     deleted_literals++;
 
-                    if (!strengthenClause(cs[j], ~l))
-                        return false;
+                    if (!strengthenClause(cs[j], ~l)){
+                        res = false;
+                        break; }
 
                     // Did current candidate get deleted from cs? Then check candidate at index j again:
                     if (var(l) == best)
                         j--;
                 }
             }
+
+        for (int i = 0; i < size; i++)
+            lit_mark[toInt(c[i])] = 0;
+        if (!res)
+            return false;
     }
 
     return true;
 }
 
 
+// Same as 'Clause::subsumes()', for a clause of 'size' literals marked in 'lit_mark'. Linear in
+// the size of 'd' (which has no duplicate or complementary literals).
+Lit SimpSolver::subsumesMarked(int size, const Clause& d) const
+{
+    int found = 0;
+    Lit ret   = lit_Undef;
+    for (int i = 0; i < d.size() && found + (ret != lit_Undef) + (d.size() - i) >= size; i++){
+        Lit p = d[i];
+        if (lit_mark[toInt(p)])
+            found++;
+        else if (lit_mark[toInt(~p)]){
+            if (ret != lit_Undef) return lit_Error;
+            ret = ~p;
+        }
+    }
+    if (found == size) return lit_Undef;
+    if (ret != lit_Undef && found + 1 == size) return ret;
+    return lit_Error;
+}
+
+
 bool SimpSolver::asymm(Var v, CRef cr)
 {
     Clause& c = ca[cr];
@@ -557,6 +665,14 @@ static void mkElimClause(vec<uint32_t>& elimclauses, Lit x)
 }
 
 
+static void mkElimClause(vec<uint32_t>& elimclauses, Lit v, Lit x)
+{
+    elimclauses.push(toInt(v));
+    elimclauses.push(toInt(x));
+    elimclauses.push(2);
+}
+
+
 static void mkElimClause(vec<uint32_t>& elimclauses, Var v, Clause& c)
 {
     int first = elimclauses.size();
@@ -583,30 +699,52 @@ static void mkElimClause(vec<uint32_t>& elimclauses, Var v, Clause& c)
 
 
 
-bool SimpSolver::eliminateVar(Var v)
+// Check wether the increase in number of clauses when eliminating 'v' with the occurrences 'cls'
+// stays within the allowed ('grow'). Moreover, no clause must exceed the limit on the maximal clause
+// size (if it is set). Only reads the solver state, so that it may run in several threads.
+bool SimpSolver::eliminable(Var v, const vec<CRef>& cls, int& n_merges) const
 {
-    assert(!frozen[v]);
-    assert(!isEliminated(v));
-    assert(value(v) == l_Undef);
-
-    // Split the occurrences into positive and negative:
-    //
-    const vec<CRef>& cls = occurs.lookup(v);
-    vec<CRef>        pos, neg;
+    vec<CRef> pos, neg;
     for (int i = 0; i < cls.size(); i++)
         (find(ca[cls[i]], mkLit(v)) ? pos : neg).push(cls[i]);
 
-    // Check wether the increase in number of clauses stays within the allowed ('grow'). Moreover, no
-    // clause must exceed the limit on the maximal clause size (if it is set):
-    //
     int cnt         = 0;
     int clause_size = 0;
+    n_merges        = 0;
 
     for (int i = 0; i < pos.size(); i++)
         for (int j = 0; j < neg.size(); j++)
-            if (merge(ca[pos[i]], ca[neg[j]], v, clause_size) && 
+            if (n_merges++, merge(ca[pos[i]], ca[neg[j]], v, clause_size) &&
                 (++cnt > cls.size() + grow || (clause_lim != -1 && clause_size > clause_lim)))
-                return true;
+                return false;
+
+    return true;
+}
+
+
+// Eliminates 'v' by resolution. Unless 'checked' (by 'eliminable()'), does nothing if the number or
+// the size of the resolvents are too large.
+bool SimpSolver::eliminateVar(Var v, bool checked)
+{
+    assert(!frozen[v]);
+    assert(!isEliminated(v));
+    assert(value(v) == l_Undef);
+
+    const vec<CRef>& cls = occurs.lookup(v);
+    if (!checked){
+        int n_merges;
+        bool elim = eliminable(v, cls, n_merges);
+        merges     += n_merges;
+        simp_steps += n_merges;
+        if (!elim)
+            return true;
+    }
+
+    // Split the occurrences into positive and negative:
+    //
+    vec<CRef> pos, neg;
+    for (int i = 0; i < cls.size(); i++)
+        (find(ca[cls[i]], mkLit(v)) ? pos : neg).push(cls[i]);
 
     // Delete and store old clauses
     eliminated[v] = true;
@@ -653,10 +791,40 @@ bool SimpSolver::substitute(Var v, Lit x)
 
     if (!ok) return false;
 
+    // Substitute in the constraints first, so that propagation does not involve 'v' anymore:
+    vec<Constraint*> constrs;
+    for (int s = 0; s < 2; s++){
+        vec<Constraint*>& ws = constr_watches[toInt(mkLit(v, s))];
+        for (int i = 0; i < ws.size(); i++)
+            if (find(constrs, ws[i]) == false)
+                constrs.push(ws[i]);
+        ws.clear();
+    }
+    for (int i = 0; i < constrs.size(); i++){
+        assert(constrs[i]->acceptsSubstitution());
+        int from = trail.size();
+        enqueue_failure = lit_Undef;
+        bool ok_constr = constrs[i]->substitute(*this, v, x);
+        if (certifiedUNSAT) explainPropagations(constrs[i], from, !ok_constr);
+        if (!ok_constr)
+            return ok = false;
+    }
+    if (constrs.size() > 0){
+        constrained[var(x)] = std::max(constrained[var(x)], (char)1);
+        if (hasConflict(propagate()))
+            return ok = false;
+    }
+
     eliminated[v] = true;
     setDecisionVar(v, false);
     const vec<CRef>& cls = occurs.lookup(v);
-    
+
+    // Save the equivalence for model extension:
+    mkElimClause(elimclauses, mkLit(v), ~x);
+    mkElimClause(elimclauses, ~mkLit(v), x);
+
+    // Add all substituted clauses before removing the originals, so that each of them is
+    // implied by unit propagation when written to the proof:
     vec<Lit>& subst_clause = add_tmp;
     for (int i = 0; i < cls.size(); i++){
         Clause& c = ca[cls[i]];
@@ -667,13 +835,124 @@ bool SimpSolver::substitute(Var v, Lit x)
             subst_clause.push(var(p) == v ? x ^ sign(p) : p);
         }
 
- 
         if (!addClause_(subst_clause))
             return ok = false;
+    }
 
-       removeClause(cls[i]);
- 
-   }
+    for (int i = 0; i < cls.size(); i++)
+        removeClause(cls[i]);
+
+    return true;
+}
+
+
+// Variables watched by constraints can not be eliminated. They can be substituted only if all
+// these constraints accept substitutions.
+void SimpSolver::updateConstrained()
+{
+    // In proofs, the explanations of a constraint must follow from its encoding on the original
+    // variables, whose equivalences with the substituted ones are deleted:
+    for (Var v = 0; v < nVars(); v++){
+        constrained[v] = 0;
+        for (int s = 0; s < 2; s++){
+            const vec<Constraint*>& ws = constr_watches[toInt(mkLit(v, s))];
+            for (int i = 0; i < ws.size() && constrained[v] < 2; i++)
+                constrained[v] = ws[i]->acceptsSubstitution() && !certifiedUNSAT ? 1 : 2;
+        }
+    }
+}
+
+
+// Find equivalent literals as strongly connected components of the binary implication graph
+// (Tarjan's algorithm), and substitute every variable of a component by its representative.
+// Variables that can not be substituted (frozen, or watched by constraints not accepting it) are
+// preferred as representatives. Returns FALSE if a literal was found to be equivalent to its
+// negation.
+bool SimpSolver::substituteEquivalences()
+{
+    if (!ok) return false;
+    assert(decisionLevel() == 0);
+
+    watchesBin.cleanAll();
+
+    int      n = 2*nVars();
+    vec<int> index(n, -1), low(n, 0), comp(n, -1);
+    vec<Lit> stack, reps;
+    vec<char> on_stack(n, 0);
+    int      next_index = 0;
+
+    struct Frame { Lit p; int i; };
+    vec<Frame> dfs;
+
+    for (int root = 0; root < n; root++){
+        Lit r = toLit(root);
+        if (index[root] >= 0 || value(r) != l_Undef || isEliminated(var(r))) continue;
+
+        index[root] = low[root] = next_index++;
+        stack.push(r); on_stack[root] = 1;
+        dfs.push({r, 0});
+
+        while (dfs.size() > 0){
+            Lit p = dfs.last().p;
+            const vec<Watcher>& ws = watchesBin[p];
+
+            if (dfs.last().i < ws.size()){
+                Lit q = ws[dfs.last().i++].blocker;
+                if (value(q) != l_Undef || isEliminated(var(q))) continue;
+                if (index[toInt(q)] < 0){
+                    index[toInt(q)] = low[toInt(q)] = next_index++;
+                    stack.push(q); on_stack[toInt(q)] = 1;
+                    dfs.push({q, 0});
+                }else if (on_stack[toInt(q)])
+                    low[toInt(p)] = std::min(low[toInt(p)], index[toInt(q)]);
+                continue;
+            }
+
+            dfs.pop();
+            if (dfs.size() > 0){
+                Lit parent = dfs.last().p;
+                low[toInt(parent)] = std::min(low[toInt(parent)], low[toInt(p)]);
+            }
+            if (low[toInt(p)] != index[toInt(p)]) continue;
+
+            // 'p' is the root of a component; choose the representative and check consistency:
+            int  id  = reps.size();
+            Lit  rep = p;
+            int  k   = stack.size();
+            do {
+                Lit q = stack[--k];
+                comp[toInt(q)] = id;
+                bool fixed_q = frozen[var(q)] || constrained[var(q)] == 2, fixed_rep = frozen[var(rep)] || constrained[var(rep)] == 2;
+                if (fixed_q > fixed_rep || (fixed_q == fixed_rep && var(q) < var(rep)))
+                    rep = q;
+            } while (stack[k] != p);
+
+            for (int j = k; j < stack.size(); j++){
+                Lit q = stack[j];
+                on_stack[toInt(q)] = 0;
+                if (comp[toInt(~q)] == id){
+                    // 'q' implies '~q' and vice versa. Adding '~q' makes propagation fail:
+                    vec<Lit> unit(1, ~q);
+                    addClause_(unit);
+                    return ok = false;
+                }
+            }
+            stack.shrink(stack.size() - k);
+            reps.push(rep);
+        }
+    }
+
+    for (Var v = 0; v < nVars(); v++){
+        if (comp[toInt(mkLit(v))] < 0) continue;
+        Lit x = reps[comp[toInt(mkLit(v))]];
+        if (var(x) == v || frozen[v] || constrained[v] == 2 || isEliminated(v) || value(v) != l_Undef) continue;
+        assert(!isEliminated(var(x)));
+        if (value(x) != l_Undef) continue; // Fixed by a unit found during an earlier substitution
+
+        if (!substitute(v, x))
+            return false;
+        substituted_vars++;
+    }
 
     return true;
 }
@@ -716,52 +995,12 @@ bool SimpSolver::eliminate(bool turn_off_elim)
       printf("c Too many clauses... No preprocessing\n");
     }
 
-    while (toPerform && (n_touched > 0 || bwdsub_assigns < trail.size() || elim_heap.size() > 0)){
-
-        gatherTouchedClauses();
-        // printf("  ## (time = %6.2f s) BWD-SUB: queue = %d, trail = %d\n", cpuTime(), subsumption_queue.size(), trail.size() - bwdsub_assigns);
-        if ((subsumption_queue.size() > 0 || bwdsub_assigns < trail.size()) && 
-            !backwardSubsumptionCheck(true)){
-            ok = false; goto cleanup; }
-
-        // Empty elim_heap and return immediately on user-interrupt:
-        if (asynch_interrupt){
-            assert(bwdsub_assigns == trail.size());
-            assert(subsumption_queue.size() == 0);
-            assert(n_touched == 0);
-            elim_heap.clear();
-            goto cleanup; }
-
-        // printf("  ## (time = %6.2f s) ELIM: vars = %d\n", cpuTime(), elim_heap.size());
-        for (int cnt = 0; !elim_heap.empty(); cnt++){
-            Var elim = elim_heap.removeMin();
-            
-            if (asynch_interrupt) break;
-
-            if (isEliminated(elim) || value(elim) != l_Undef) continue;
-
-            if (verbosity >= 2 && cnt % 100 == 0)
-                printf("elimination left: %10d\r", elim_heap.size());
-
-            if (use_asymm){
-                // Temporarily freeze variable. Otherwise, it would immediately end up on the queue again:
-                bool was_frozen = frozen[elim];
-                frozen[elim] = true;
-                if (!asymmVar(elim)){
-                    ok = false; goto cleanup; }
-                frozen[elim] = was_frozen; }
-
-            // At this point, the variable may have been set by assymetric branching, so check it
-            // again. Also, don't eliminate frozen variables:
-            if (use_elim && value(elim) == l_Undef && !frozen[elim] && !eliminateVar(elim)){
-                ok = false; goto cleanup; }
-
-            checkGarbage(simp_garbage_frac);
-        }
+    updateConstrained();
+    if (toPerform && use_subst && !substituteEquivalences())
+        ok = false;
 
-        assert(subsumption_queue.size() == 0);
-    }
- cleanup:
+    if (toPerform && ok && !eliminateQueued())
+        ok = false;
 
     // If no more simplification is needed, free all simplification-related data structures:
     if (turn_off_elim){
@@ -795,6 +1034,384 @@ bool SimpSolver::eliminate(bool turn_off_elim)
 }
 
 
+// Main simplification loop. Returns FALSE if the formula was found unsatisfiable.
+bool SimpSolver::eliminateQueued()
+{
+    while (n_touched > 0 || bwdsub_assigns < trail.size() || elim_heap.size() > 0){
+
+        gatherTouchedClauses();
+        // printf("  ## (time = %6.2f s) BWD-SUB: queue = %d, trail = %d\n", cpuTime(), subsumption_queue.size(), trail.size() - bwdsub_assigns);
+        if ((subsumption_queue.size() > 0 || bwdsub_assigns < trail.size()) && 
+            !backwardSubsumptionCheck(true))
+            return false;
+
+        // Empty elim_heap and return immediately on user-interrupt (or exhausted budget):
+        if (simpInterrupted()){
+            assert(bwdsub_assigns == trail.size());
+            assert(subsumption_queue.size() == 0);
+            assert(n_touched == 0);
+            elim_heap.clear();
+            return true; }
+
+        // printf("  ## (time = %6.2f s) ELIM: vars = %d\n", cpuTime(), elim_heap.size());
+        if (use_elim && !use_asymm && elim_threads > 1){
+            if (!eliminateParallel())
+                return false;
+        }else{
+            for (int cnt = 0; !elim_heap.empty(); cnt++){
+                Var elim = elim_heap.removeMin();
+            
+                if (simpInterrupted()) break;
+
+                if (isEliminated(elim) || value(elim) != l_Undef) continue;
+
+                if (verbosity >= 2 && cnt % 100 == 0)
+                    printf("elimination left: %10d\r", elim_heap.size());
+
+                if (use_asymm){
+                    // Temporarily freeze variable. Otherwise, it would immediately end up on the queue again:
+                    bool was_frozen = frozen[elim];
+                    frozen[elim] = true;
+                    if (!asymmVar(elim))
+                        return false;
+                    frozen[elim] = was_frozen; }
+
+                // At this point, the variable may have been set by assymetric branching, so check it
+                // again. Also, don't eliminate frozen variables:
+                if (use_elim && value(elim) == l_Undef && !frozen[elim] && !constrained[elim] && !eliminateVar(elim))
+                    return false;
+
+                checkGarbage(simp_garbage_frac);
+            }
+        }
+
+        assert(subsumption_queue.size() == 0);
+    }
+    return true;
+}
+
+
+// Variable elimination with the checks of 'eliminable()' spread over 'elim_threads' threads.
+// Candidates are taken from 'elim_heap' in batches and checked concurrently on the same clauses.
+// The eliminations are then done sequentially in the order of the batch; since most candidates are
+// rejected, only those whose clauses changed since the checks ('elim_busy', set by 'removeClause()'
+// and 'strengthenClause()', or all of them after new top-level units) are checked again. The result
+// is therefore independent of the number of threads, but not identical to the sequential loop of
+// 'eliminateQueued()', which reorders the heap after each elimination.
+bool SimpSolver::eliminateParallel()
+{
+    const int              max_batch = 1024;  // Independent of the number of threads
+    vec<Var>               batch;
+    vec<const vec<CRef>*>  batch_occs;
+    vec<char>              elim;
+    vec<int>               n_merges;
+    bool                   res = true;
+    elim_busy.growTo(nVars(), 0);
+
+    // The workers are started once and check each batch along with this thread:
+    std::mutex               mtx;
+    std::condition_variable  cv;
+    int                      round = 0, running = 0;
+    bool                     stop = false;
+    std::atomic<int>         next(0);
+    auto check = [&](){
+        for (int i; (i = next++) < batch.size();)
+            elim[i] = eliminable(batch[i], *batch_occs[i], n_merges[i]);
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < elim_threads; i++)
+        workers.emplace_back([&](){
+            for (int seen = 0;;){
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&](){ return stop || round != seen; });
+                if (stop) return;
+                seen = round;
+                lock.unlock();
+                check();
+                lock.lock();
+                if (--running == 0) cv.notify_all();
+            }
+        });
+
+    while (res && !elim_heap.empty() && !simpInterrupted()){
+        batch.clear();
+        batch_occs.clear();
+        while (!elim_heap.empty() && batch.size() < max_batch){
+            Var v = elim_heap.removeMin();
+            if (isEliminated(v) || value(v) != l_Undef || frozen[v] || constrained[v]) continue;
+            batch.push(v);
+            batch_occs.push(&occurs.lookup(v));
+        }
+
+        if (verbosity >= 2)
+            printf("elimination left: %10d\r", elim_heap.size());
+
+        // Check the candidates concurrently:
+        elim.clear();
+        elim.growTo(batch.size(), 0);
+        n_merges.clear();
+        n_merges.growTo(batch.size(), 0);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            next = 0;
+            running = workers.size();
+            round++;
+        }
+        cv.notify_all();
+        check();
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&](){ return running == 0; });
+        }
+
+        // Eliminate:
+        int trail_size = trail.size();
+        for (int i = 0; i < batch.size(); i++){
+            Var v = batch[i];
+            merges     += n_merges[i];
+            simp_steps += n_merges[i];
+            if (isEliminated(v) || value(v) != l_Undef)
+                continue;
+
+            bool checked = trail.size() == trail_size && !elim_busy[v];
+            if (checked && !elim[i])
+                continue;
+
+            if (!eliminateVar(v, checked)){
+                res = false;
+                break; }
+        }
+        for (int i = 0; i < elim_busy_vars.size(); i++)
+            elim_busy[elim_busy_vars[i]] = 0;
+        elim_busy_vars.clear();
+
+        checkGarbage(simp_garbage_frac);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+    }
+    cv.notify_all();
+    for (std::thread& t : workers)
+        t.join();
+    elim_busy.clear(true);
+    return res;
+}
+
+
+//=================================================================================================
+// Inprocessing:
+
+
+// Rebuild occurrence lists and counters from the original clauses. Variables whose occurrence
+// counters changed since the last round are queued for subsumption and elimination.
+void SimpSolver::rebuildOccurrences()
+{
+    occurs.clear(true);
+    n_occ.clear();
+    touched.clear();
+    elim_heap.clear();
+    subsumption_queue.clear();
+    n_touched = 0;
+
+    for (Var v = 0; v < nVars(); v++){
+        occurs.init(v);
+        n_occ.push(0);
+        n_occ.push(0);
+        touched.push(0);
+    }
+    for (int i = 0; i < clauses.size(); i++){
+        const Clause& c = ca[clauses[i]];
+        if (c.mark()) continue;
+        for (int j = 0; j < c.size(); j++){
+            occurs[var(c[j])].push(clauses[i]);
+            n_occ[toInt(c[j])]++;
+        }
+    }
+
+    for (Var v = 0; v < nVars(); v++){
+        if (frozen[v] || constrained[v] || isEliminated(v) || value(v) != l_Undef) continue;
+        Lit p = mkLit(v);
+        if (2*v+1 < inprocess_occ.size() &&
+            inprocess_occ[toInt(p)] == n_occ[toInt(p)] && inprocess_occ[toInt(~p)] == n_occ[toInt(~p)])
+            continue;
+        touched[v] = 1;
+        n_touched++;
+        elim_heap.insert(v);
+    }
+}
+
+
+// Learnt clauses over eliminated variables are still implied, but useless; drop them.
+void SimpSolver::removeEliminatedLearnts()
+{
+    vec<CRef>* sets[] = {&learnts, &permanentLearnts};
+    for (vec<CRef>* cs : sets){
+        int i, j;
+        for (i = j = 0; i < cs->size(); i++){
+            CRef cr = (*cs)[i];
+            const Clause& c = ca[cr];
+            bool elim = false;
+            for (int k = 0; k < c.size() && !elim; k++)
+                elim = isEliminated(var(c[k]));
+            if (elim)
+                Solver::removeClause(cr);
+            else
+                (*cs)[j++] = cr;
+        }
+        cs->shrink(i - j);
+    }
+}
+
+
+// Forward subsumption of the learnt clauses. Clauses are visited by increasing size, and each
+// clause kept is watched by one of its literals only: a learnt clause is removed when all the
+// literals of an earlier clause watched by one of its literals are in it.
+void SimpSolver::subsumeLearnts()
+{
+    vec<CRef> cs;
+    vec<CRef>* sets[] = {&clauses, &permanentLearnts, &learnts};
+    for (vec<CRef>* s : sets)
+        for (int i = 0; i < s->size(); i++){
+            Clause& c = ca[(*s)[i]];
+            if (!c.mark() && !c.getOneWatched())
+                cs.push((*s)[i]); }
+    sort(cs, SubsumeLt(ca));
+
+    vec<vec<OneWatch> > ws(2*nVars());
+    int removed = 0;
+    for (int i = 0; i < cs.size() && !simpInterrupted(); i++){
+        const Clause& c = ca[cs[i]];
+        uint64_t abst = 0;
+        for (int j = 0; j < c.size(); j++){
+            abst |= (uint64_t)1 << (var(c[j]) & 63);
+            lit_mark[toInt(c[j])] = 1; }
+
+        bool subsumed = false;
+        for (int j = 0; j < c.size() && !subsumed; j++){
+            const vec<OneWatch>& w = ws[toInt(c[j])];
+            simp_steps += w.size();
+            for (int k = 0; k < w.size() && !subsumed; k++){
+                if ((w[k].abst & ~abst) != 0) continue;
+                const Clause& d = ca[w[k].cr];
+                int l = 0;
+                while (l < d.size() && lit_mark[toInt(d[l])]) l++;
+                subsumed = l == d.size();
+            }
+        }
+
+        for (int j = 0; j < c.size(); j++)
+            lit_mark[toInt(c[j])] = 0;
+
+        if (subsumed && c.learnt()){
+            Solver::removeClause(cs[i]);
+            removed++;
+        }else if (!subsumed){
+            // Watch the literal with the fewest watches:
+            Lit best = c[0];
+            for (int j = 1; j < c.size(); j++)
+                if (ws[toInt(c[j])].size() < ws[toInt(best)].size())
+                    best = c[j];
+            ws[toInt(best)].push(OneWatch{cs[i], abst});
+        }
+    }
+
+    if (removed == 0) return;
+    subsumed_learnts += removed;
+    vec<CRef>* learnt_sets[] = {&permanentLearnts, &learnts};
+    for (vec<CRef>* s : learnt_sets){
+        int j = 0;
+        for (int i = 0; i < s->size(); i++)
+            if (!ca[(*s)[i]].mark())
+                (*s)[j++] = (*s)[i];
+        s->shrink(s->size() - j);
+    }
+}
+
+
+// Called by 'Solver::solve_()' at level 0 between restarts. Performs a round of subsumption and
+// variable elimination, within 'inprocess_effort' steps, when enough conflicts or new top-level
+// units were found since the last round. Returns FALSE if the formula was found unsatisfiable.
+bool SimpSolver::inprocess()
+{
+    assert(decisionLevel() == 0);
+    if (!use_inprocessing || (!use_elim && !use_asymm && subsumption_lim == 0))
+        return true;
+    if (next_inprocess == 0){
+        // The first round waits for 'inprocess_int' conflicts (or units) after preprocessing
+        next_inprocess  = conflicts + inprocess_int;
+        inprocess_trail = trail.size(); }
+    if (conflicts < next_inprocess && (inprocess_units == 0 || trail.size() - inprocess_trail < inprocess_units))
+        return true;
+    if (clauses.size() > 4800000)
+        return true;
+
+    inprocessings++;
+    if (!simplify())
+        return false;
+
+    // Assumptions must be temporarily frozen:
+    vec<Var> extra_frozen;
+    for (int i = 0; i < assumptions.size(); i++){
+        Var v = var(assumptions[i]);
+        if (!frozen[v]){
+            frozen[v] = true;
+            extra_frozen.push(v); } }
+
+    bool was_simplifying = use_simplification;
+    if (!was_simplifying){
+        // Clause abstractions are needed for subsumption
+        if (!ca.extra_clause_field){
+            ca.extra_clause_field = true;
+            garbageCollect(); }
+        vec<Lit> dummy(1,lit_Undef);
+        bwdsub_tmpunit     = ca.alloc(dummy);
+        use_simplification = true;
+        remove_satisfied   = false;
+    }
+
+    updateConstrained();
+    rebuildOccurrences();
+    simp_steps_limit = simp_steps + inprocess_effort;
+    bool res = (!use_subst || substituteEquivalences()) && eliminateQueued();
+    simp_steps_limit = -1;
+    elim_heap.clear();
+
+    if (res){
+        removeEliminatedLearnts();
+        subsumeLearnts(); }
+    cleanUpClauses();
+    n_occ.copyTo(inprocess_occ);
+
+    for (int i = 0; i < extra_frozen.size(); i++)
+        frozen[extra_frozen[i]] = false;
+
+    if (!was_simplifying){
+        touched  .clear(true);
+        occurs   .clear(true);
+        n_occ    .clear(true);
+        elim_heap.clear(true);
+        subsumption_queue.clear(true);
+        ca.free(bwdsub_tmpunit);
+        bwdsub_tmpunit     = CRef_Undef;
+        use_simplification = false;
+        remove_satisfied   = true;
+    }
+
+    next_inprocess  = conflicts + inprocess_int;
+    inprocess_trail = trail.size();
+    rebuildOrderHeap();
+    checkGarbage();
+
+    if (verbosity >= 2)
+        printf("c inprocessing round %d: %d eliminated variables\n", inprocessings, eliminated_vars);
+
+    if (!res) ok = false;
+    return res;
+}
+
+
 void SimpSolver::cleanUpClauses()
 {
     occurs.cleanAll();
@@ -841,6 +1458,7 @@ void SimpSolver::garbageCollect()
 
     cleanUpClauses();
     to.extra_clause_field = ca.extra_clause_field; // NOTE: this is important to keep (or lose) the extra fields.
+    to.clause_ids = ca.clause_ids;
     relocAll(to);
     Solver::relocAll(to);
     if (verbosity >= 2)
@@ -86,6 +86,9 @@ class SimpSolver : public Solver {
     bool    addClause (Lit p, Lit q);        // Add a binary clause to the solver.
     bool    addClause (Lit p, Lit q, Lit r); // Add a ternary clause to the solver.
     virtual bool    addClause_(      vec<Lit>& ps);
+    virtual bool    addClauses(const Lit* lits, const uint32_t* offsets, int n_clauses);
+    virtual void    reserveVars(int n);
+    virtual void    useLRAT    ();
     bool    substitute(Var v, Lit x);  // Replace all occurences of v with x (may cause a contradiction).
 
     // Variable mode:
@@ -130,11 +133,20 @@ class SimpSolver : public Solver {
     bool    use_asymm;         // Shrink clauses by asymmetric branching.
     bool    use_rcheck;        // Check if a clause is already implied. Prett costly, and subsumes subsumptions :)
     bool    use_elim;          // Perform variable elimination.
+    int     elim_threads;      // Number of threads deciding variable eliminations (1 = sequential).
+    bool    use_subst;         // Substitute equivalent literals found in the binary implication graph.
+    bool    use_inprocessing;  // Perform rounds of subsumption and variable elimination during search.
+    int     inprocess_int;     // Number of conflicts between two inprocessing rounds.
+    int     inprocess_units;   // Number of new top-level units triggering an inprocessing round (0 = ignored).
+    int64_t inprocess_effort;  // Resolution and subsumption steps allowed per inprocessing round.
     // Statistics:
     //
     int     merges;
     int     asymm_lits;
     int     eliminated_vars;
+    int     substituted_vars;
+    int     inprocessings;
+    int     subsumed_learnts;
     bool                use_simplification;
 
  protected:
@@ -147,8 +159,11 @@ class SimpSolver : public Solver {
 
         // TODO: are 64-bit operations here noticably bad on 32-bit platforms? Could use a saturating
         // 32-bit implementation instead then, but this will have to do for now.
+        typedef uint64_t Key;
         uint64_t cost  (Var x)        const { return (uint64_t)n_occ[toInt(mkLit(x))] * (uint64_t)n_occ[toInt(~mkLit(x))]; }
         bool operator()(Var x, Var y) const { return cost(x) < cost(y); }
+        Key  key       (Var x)        const { return cost(x); }
+        bool keyLt     (Key a, Key b) const { return a < b; }
         
         // TODO: investigate this order alternative more.
         // bool operator()(Var x, Var y) const { 
@@ -157,6 +172,18 @@ class SimpSolver : public Solver {
         //     return c_x < c_y || c_x == c_y && x < y; }
     };
 
+    struct SubsumeLt {
+        const ClauseAllocator& ca;
+        explicit SubsumeLt(const ClauseAllocator& _ca) : ca(_ca) {}
+        bool operator()(CRef x, CRef y) const {  // By size, original clauses before learnt ones
+            if (ca[x].size() != ca[y].size()) return ca[x].size() < ca[y].size();
+            return !ca[x].learnt() && ca[y].learnt(); } };
+
+    struct OneWatch {
+        CRef     cr;
+        uint64_t abst;
+    };
+
     struct ClauseDeleted {
         const ClauseAllocator& ca;
         explicit ClauseDeleted(const ClauseAllocator& _ca) : ca(_ca) {}
@@ -170,12 +197,21 @@ class SimpSolver : public Solver {
     OccLists<Var, vec<CRef>, ClauseDeleted>
                         occurs;
     vec<int>            n_occ;
-    Heap<ElimLt>        elim_heap;
+    SolverHeap<ElimLt>  elim_heap;
     Queue<CRef>         subsumption_queue;
     vec<char>           frozen;
     vec<char>           eliminated;
+    vec<char>           constrained;       // 1 if watched by constraints accepting substitutions, 2 if watched by others
+    vec<char>           lit_mark;          // Literals of the clause checked for subsumption
     int                 bwdsub_assigns;
     int                 n_touched;
+    int64_t             simp_steps;        // Resolution and subsumption steps
+    int64_t             simp_steps_limit;  // -1 means no limit
+    uint64_t            next_inprocess;    // Conflicts at which the next inprocessing round may start (0 = not scheduled yet)
+    int                 inprocess_trail;   // Number of top-level assignments at the end of the last round
+    vec<int>            inprocess_occ;     // 'n_occ' at the end of the last round
+    vec<char>           elim_busy;         // Variables whose clauses changed in the batch of 'eliminateParallel()' (empty otherwise)
+    vec<Var>            elim_busy_vars;    // The variables set in 'elim_busy'
 
     // Temporaries:
     //
@@ -189,11 +225,25 @@ class SimpSolver : public Solver {
     void          updateElimHeap           (Var v);
     void          gatherTouchedClauses     ();
     bool          merge                    (const Clause& _ps, const Clause& _qs, Var v, vec<Lit>& out_clause);
-    bool          merge                    (const Clause& _ps, const Clause& _qs, Var v, int& size);
+    bool          merge                    (const Clause& _ps, const Clause& _qs, Var v, int& size) const;
     bool          backwardSubsumptionCheck (bool verbose = false);
-    bool          eliminateVar             (Var v);
+    Lit           subsumesMarked           (int size, const Clause& d) const;
+    bool          eliminable               (Var v, const vec<CRef>& cls, int& n_merges) const;
+    bool          eliminateVar             (Var v, bool checked = false);
+    bool          eliminateParallel        ();
+    void          markBusy                 (const Clause& c);
+    void          updateConstrained        ();
+    bool          substituteEquivalences   ();
+    bool          eliminateQueued          ();  // Subsumption and elimination on the touched clauses and 'elim_heap'
+    bool          simpInterrupted          () const;
+    bool          inprocess                ();
+    void          rebuildOccurrences       ();
+    void          removeEliminatedLearnts  ();
+    void          subsumeLearnts           ();
     void          extendModel              ();
 
+    virtual void  adoptClause              (CRef cr);
+    void          addOccurrences           (CRef cr);   // Register a new problem clause for simplification
     void          removeClause             (CRef cr,bool inPurgatory=false);
     bool          strengthenClause         (CRef cr, Lit l);
     void          cleanUpClauses           ();
@@ -207,6 +257,14 @@ class SimpSolver : public Solver {
 
 
 inline bool SimpSolver::isEliminated (Var v) const { return eliminated[v]; }
+inline void SimpSolver::markBusy(const Clause& c) {
+    if (elim_busy.size() > 0)
+        for (int i = 0; i < c.size(); i++)
+            if (!elim_busy[var(c[i])]){
+                elim_busy[var(c[i])] = 1;
+                elim_busy_vars.push(var(c[i])); } }
+inline bool SimpSolver::simpInterrupted() const {
+    return asynch_interrupt || (simp_steps_limit >= 0 && simp_steps > simp_steps_limit); }
 inline void SimpSolver::updateElimHeap(Var v) {
     assert(use_simplification);
     // if (!frozen[v] && !isEliminated(v) && value(v) == l_Undef)
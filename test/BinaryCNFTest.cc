@@ -0,0 +1,119 @@
+// Enable assert() even on release build
+#undef NDEBUG
+
+#include <cassert>
+#include <random>
+#include <unistd.h>
+
+#include "test/Test.h"
+#include "test/TestUtil.h"
+#include "core/BinaryCNF.h"
+#include "constraints/AtMost.h"
+#include "simp/SimpSolver.h"
+
+using namespace Glucose;
+
+namespace {
+
+const int kVars = 12;
+
+std::vector<std::vector<Lit>> RandomClauses(std::mt19937& rng) {
+    std::vector<std::vector<Lit>> clauses;
+    clauses.push_back({mkLit(rng() % kVars, rng() % 2)});
+    for (int i = 0; i < 30; ++i) {
+        std::vector<Lit> clause;
+        for (int j = 0; j < 3; ++j) clause.push_back(mkLit(rng() % kVars, rng() % 2));
+        clauses.push_back(clause);
+    }
+    return clauses;
+}
+
+std::vector<BinaryConstraint> RandomConstraints(std::mt19937& rng) {
+    std::vector<Lit> lits;
+    Var first = rng() % kVars;  // Distinct variables
+    for (int i = 0; i < 5; ++i) lits.push_back(mkLit((first + i) % kVars, rng() % 2));
+    return {{BinaryConstraint::AtMost, 2, lits}};
+}
+
+void AddProblem(Solver& S, const std::vector<std::vector<Lit>>& clauses, const std::vector<BinaryConstraint>& constrs) {
+    while (S.nVars() < kVars) S.newVar();
+    for (auto& clause : clauses) {
+        vec<Lit> ps;
+        for (Lit l : clause) ps.push(l);
+        S.addClause(ps);
+    }
+    for (auto& c : constrs) S.addConstraint(std::make_unique<AtMost>(std::vector<Lit>(c.lits), c.param));
+}
+
+// Loads the problem from `file` into `S` and counts its models.
+int CountLoaded(Solver& S, const std::string& file) {
+    InputFile in(file.c_str());
+    assert(isBinaryCNF(in));
+    std::vector<BinaryConstraint> constrs;
+    loadBinaryCNF(in, S, constrs);
+    for (auto& c : constrs) {
+        assert(c.type == BinaryConstraint::AtMost);
+        S.addConstraint(std::make_unique<AtMost>(std::vector<Lit>(c.lits), c.param));
+    }
+    std::vector<Var> vars;
+    for (int i = 0; i < kVars; ++i) vars.push_back(i);
+    return CountNumAssignment(S, vars);
+}
+
+}
+
+DEFINE_TEST(binary_cnf_round_trip) {
+    char name[] = "/tmp/glucose_testXXXXXX";
+    close(mkstemp(name));
+    std::vector<Var> vars;
+    for (int i = 0; i < kVars; ++i) vars.push_back(i);
+
+    for (unsigned seed = 0; seed < 40; ++seed) {
+        std::mt19937 rng(seed);
+        auto clauses = RandomClauses(rng);
+        auto constrs = RandomConstraints(rng);
+
+        int expected;
+        {
+            Solver S;
+            AddProblem(S, clauses, constrs);
+            expected = CountNumAssignment(S, vars);
+        }
+
+        // Written by a solver with clause abstractions, and by one without them
+        for (int simp = 0; simp < 2; ++simp) {
+            {
+                SimpSolver S;
+                S.use_simplification = simp;
+                if (!simp) S.eliminate(true);
+                AddProblem(S, clauses, constrs);
+                S.toBinary(name, constrs);
+            }
+            // Loaded by both kinds of solvers, whose clause region may or may not be used as such
+            Solver S1;
+            assert(CountLoaded(S1, name) == expected);
+            SimpSolver S2;
+            for (int i = 0; i < kVars; ++i) S2.setFrozen(S2.newVar(), true);
+            assert(CountLoaded(S2, name) == expected);
+        }
+    }
+    unlink(name);
+}
+
+DEFINE_TEST(binary_cnf_invalid) {
+    char name[] = "/tmp/glucose_testXXXXXX";
+    close(mkstemp(name));
+    {
+        Solver S;
+        std::mt19937 rng(0);
+        AddProblem(S, RandomClauses(rng), {});
+        S.toBinary(name);
+    }
+    {
+        InputFile in(name);
+        BinaryCNF cnf;
+        assert(cnf.read(in.begin(), in.end() - in.begin()));
+        assert(!cnf.read(in.begin(), in.end() - in.begin() - 4));
+    }
+    unlink(name);
+}
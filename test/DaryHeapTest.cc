@@ -0,0 +1,71 @@
+// Enable assert() even on release build
+#undef NDEBUG
+
+#include <cassert>
+#include <random>
+
+#include "test/Test.h"
+#include "mtl/DaryHeap.h"
+
+using namespace Glucose;
+
+namespace {
+
+struct KeyLt {
+    typedef int Key;
+    const vec<int>& keys;
+    KeyLt(const vec<int>& k) : keys(k) {}
+    Key  key  (int n)        const { return keys[n]; }
+    bool keyLt(Key a, Key b) const { return a < b; }
+};
+
+}
+
+DEFINE_TEST(dary_heap_random_operations) {
+    std::mt19937 rng(42);
+    const int n = 200;
+    vec<int> keys(n, 0);
+    DaryHeap<KeyLt, 4> heap((KeyLt(keys)));
+
+    for (int step = 0; step < 20000; ++step) {
+        int x = rng() % n;
+        switch (rng() % 4) {
+        case 0:
+            if (!heap.inHeap(x)) {
+                keys[x] = rng() % 1000;
+                heap.insert(x);
+            }
+            break;
+        case 1:
+            if (heap.inHeap(x)) {
+                keys[x] -= rng() % 100;
+                heap.decrease(x);
+            }
+            break;
+        case 2:
+            keys[x] = rng() % 1000;
+            if (heap.inHeap(x)) heap.update(x);
+            break;
+        case 3:
+            if (!heap.empty()) {
+                int best = heap.removeMin();
+                assert(!heap.inHeap(best));
+                for (int i = 0; i < heap.size(); ++i) {
+                    assert(keys[best] <= keys[heap[i]]);
+                }
+            }
+            break;
+        }
+    }
+
+    vec<int> all;
+    for (int i = 0; i < n; ++i) all.push(i);
+    heap.build(all);
+    assert(heap.size() == n);
+    int last = -1000000;
+    while (!heap.empty()) {
+        int x = heap.removeMin();
+        assert(last <= keys[x]);
+        last = keys[x];
+    }
+}
@@ -0,0 +1,127 @@
+// Enable assert() even on release build
+#undef NDEBUG
+
+#include <algorithm>
+#include <cassert>
+#include <random>
+
+#include "test/Test.h"
+#include "test/TestUtil.h"
+#include "constraints/AtMost.h"
+#include "constraints/EncodingDetection.h"
+#include "constraints/Xor.h"
+
+using namespace Glucose;
+
+namespace {
+
+int CountWithDetection(int n, std::vector<std::vector<Lit>> clauses, bool detect, DetectedEncodings* found = nullptr) {
+    DetectedEncodings enc;
+    if (detect) enc = DetectEncodings(n, clauses);
+
+    Solver S;
+    std::vector<Var> vars;
+    for (int i = 0; i < n; ++i) {
+        vars.push_back(S.newVar());
+    }
+    for (auto& clause : clauses) {
+        vec<Lit> ps;
+        for (Lit l : clause) ps.push(l);
+        S.addClause(ps);
+    }
+    for (auto& amo : enc.at_most_ones) {
+        S.addConstraint(std::make_unique<AtMost>(std::vector<Lit>(amo), 1));
+    }
+    for (auto& [lits, parity] : enc.xors) {
+        S.addConstraint(std::make_unique<Xor>(lits, parity));
+    }
+    if (found) *found = enc;
+    return CountNumAssignment(S, vars);
+}
+
+}
+
+DEFINE_TEST(encoding_detection_xor) {
+    // x0 ^ x1 ^ x2 ^ x3 = 1, x2 ^ x4 ^ x5 = 0
+    std::vector<std::vector<Lit>> clauses;
+    for (int mask = 0; mask < 16; ++mask) {
+        if (__builtin_popcount(mask) % 2 == 0) {
+            clauses.push_back({mkLit(0, mask & 1), mkLit(1, mask & 2), mkLit(2, mask & 4), mkLit(3, mask & 8)});
+        }
+    }
+    for (int mask = 0; mask < 8; ++mask) {
+        if (__builtin_popcount(mask) % 2 == 1) {
+            clauses.push_back({mkLit(5, mask & 4), mkLit(2, mask & 1), mkLit(4, mask & 2)});
+        }
+    }
+    clauses.push_back({mkLit(0), mkLit(4)});
+
+    DetectedEncodings found;
+    int expected = CountWithDetection(7, clauses, false);
+    assert(CountWithDetection(7, clauses, true, &found) == expected);
+    assert(found.xors.size() == 2);
+    assert(found.n_removed_clauses == 12);
+}
+
+DEFINE_TEST(encoding_detection_at_most_one) {
+    std::vector<std::vector<Lit>> clauses;
+
+    // Pairwise encoding over x0, ..., x5
+    for (int i = 0; i < 6; ++i) {
+        for (int j = i + 1; j < 6; ++j) {
+            clauses.push_back({~mkLit(i), ~mkLit(j)});
+        }
+    }
+
+    // Sequential counter encoding over x6, ..., x11, with auxiliary variables s12, ..., s16
+    auto x = [](int i) { return mkLit(6 + i); };
+    auto s = [](int i) { return mkLit(12 + i); };
+    clauses.push_back({~x(0), s(0)});
+    for (int i = 1; i < 5; ++i) {
+        clauses.push_back({~x(i), s(i)});
+        clauses.push_back({~s(i - 1), s(i)});
+        clauses.push_back({~x(i), ~s(i - 1)});
+    }
+    clauses.push_back({~x(5), ~s(4)});
+
+    std::mt19937 rng(0);
+    for (int i = 0; i < 8; ++i) {
+        clauses.push_back({mkLit(rng() % 17, rng() % 2), mkLit(rng() % 17, rng() % 2), mkLit(rng() % 17, rng() % 2)});
+    }
+
+    DetectedEncodings found;
+    int expected = CountWithDetection(17, clauses, false);
+    assert(CountWithDetection(17, clauses, true, &found) == expected);
+    assert(found.n_removed_clauses == 15);
+
+    bool pairwise = false, sequential = false;
+    for (auto& amo : found.at_most_ones) {
+        std::vector<Lit> lits = amo;
+        std::sort(lits.begin(), lits.end());
+        pairwise |= lits == std::vector<Lit>{mkLit(0), mkLit(1), mkLit(2), mkLit(3), mkLit(4), mkLit(5)};
+        sequential |= lits == std::vector<Lit>{x(0), x(1), x(2), x(3), x(4), x(5)};
+    }
+    assert(pairwise && sequential);
+}
+
+DEFINE_TEST(encoding_detection_random) {
+    int detected = 0;
+    for (unsigned seed = 0; seed < 30; ++seed) {
+        std::mt19937 rng(seed);
+        int n = 12;
+        std::vector<std::vector<Lit>> clauses;
+        for (int i = 0; i < 12; ++i) {
+            int size = 2 + rng() % 2;
+            std::vector<Lit> clause;
+            for (int j = 0; j < size; ++j) clause.push_back(mkLit(rng() % n, rng() % 2));
+            clauses.push_back(clause);
+        }
+        for (int i = 0; i < 20; ++i) {
+            clauses.push_back({~mkLit(rng() % n), ~mkLit(rng() % n)});
+        }
+        DetectedEncodings found;
+        assert(CountWithDetection(n, clauses, true, &found) == CountWithDetection(n, clauses, false));
+        detected += found.at_most_ones.size();
+    }
+    assert(detected > 0);
+}
@@ -0,0 +1,121 @@
+// Enable assert() even on release build
+#undef NDEBUG
+
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include <string>
+#include <unistd.h>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef USE_LZMA
+#include <lzma.h>
+#endif
+
+#include "test/Test.h"
+#include "core/Dimacs.h"
+#include "constraints/EncodingDetection.h"
+
+using namespace Glucose;
+
+namespace {
+
+// A DIMACS text larger than the blocks of `InputFile`, with its clauses
+std::string RandomDimacs(std::vector<std::vector<Lit>>& clauses) {
+    std::mt19937 rng(0);
+    int n = 1000000;
+    std::string text = "c random\np cnf 1000000 300001\n";
+    for (int i = 0; i < 300000; ++i) {
+        if (i % 1000 == 0) text += "c comment 0\n";
+        std::vector<Lit> clause;
+        int size = 1 + rng() % 4;
+        for (int j = 0; j < size; ++j) {
+            // Mix short and long numbers, to test both paths of `parseInt`
+            int v = (j % 2 == 0) ? rng() % n : rng() % 10;
+            bool neg = rng() % 2;
+            clause.push_back(mkLit(v, neg));
+            text += (neg ? "-" : "") + std::to_string(v + 1) + ((rng() % 8 == 0) ? "  \n " : " ");
+        }
+        text += "0\n";
+        clauses.push_back(clause);
+    }
+    text += "-1000000 0\n";
+    clauses.push_back({~mkLit(n - 1)});
+    return text;
+}
+
+std::string TempFile(const void* data, size_t size) {
+    char name[] = "/tmp/glucose_testXXXXXX";
+    int fd = mkstemp(name);
+    assert(fd >= 0);
+    assert(write(fd, data, size) == (ssize_t)size);
+    close(fd);
+    return name;
+}
+
+void CheckParse(const std::string& filename, const std::vector<std::vector<Lit>>& expected, int n_threads = 1,
+                bool ordered = true) {
+    InputFile in(filename.c_str());
+    assert(in.isOpen());
+    ClauseCollector collector;
+    parse_DIMACS_parallel(in, collector, n_threads, ordered);
+    assert(collector.nVars() == 1000000);
+    if (ordered) {
+        assert(collector.clauses == expected);
+    } else {
+        std::vector<std::vector<Lit>> sorted = expected;
+        std::sort(sorted.begin(), sorted.end());
+        std::sort(collector.clauses.begin(), collector.clauses.end());
+        assert(collector.clauses == sorted);
+    }
+    unlink(filename.c_str());
+}
+
+}
+
+DEFINE_TEST(input_file_plain) {
+    std::vector<std::vector<Lit>> clauses;
+    std::string text = RandomDimacs(clauses);
+    CheckParse(TempFile(text.data(), text.size()), clauses);
+}
+
+DEFINE_TEST(input_file_parallel) {
+    std::vector<std::vector<Lit>> clauses;
+    std::string text = RandomDimacs(clauses);
+    CheckParse(TempFile(text.data(), text.size()), clauses, 4, true);
+    CheckParse(TempFile(text.data(), text.size()), clauses, 3, false);
+}
+
+#ifdef USE_ZLIB
+DEFINE_TEST(input_file_gzip) {
+    std::vector<std::vector<Lit>> clauses;
+    std::string text = RandomDimacs(clauses);
+
+    // Two gzip members, which are read as one stream
+    char name[] = "/tmp/glucose_testXXXXXX";
+    close(mkstemp(name));
+    size_t half = text.find('\n', text.size() / 2) + 1;
+    for (int i = 0; i < 2; ++i) {
+        gzFile out = gzopen(name, i == 0 ? "wb" : "ab");
+        std::string part = i == 0 ? text.substr(0, half) : text.substr(half);
+        assert(gzwrite(out, part.data(), part.size()) == (int)part.size());
+        gzclose(out);
+    }
+    CheckParse(name, clauses);
+}
+#endif
+
+#ifdef USE_LZMA
+DEFINE_TEST(input_file_xz) {
+    std::vector<std::vector<Lit>> clauses;
+    std::string text = RandomDimacs(clauses);
+
+    std::vector<uint8_t> compressed(text.size() + (1 << 16));
+    size_t size = 0;
+    assert(lzma_easy_buffer_encode(1, LZMA_CHECK_CRC64, NULL, (const uint8_t*)text.data(), text.size(),
+                                   compressed.data(), &size, compressed.size()) == LZMA_OK);
+    CheckParse(TempFile(compressed.data(), size), clauses);
+}
+#endif
@@ -0,0 +1,226 @@
+// Enable assert() even on release build
+#undef NDEBUG
+
+#include <atomic>
+#include <cassert>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "test/Test.h"
+#include "constraints/AtMost.h"
+#include "parallel/ClauseFilter.h"
+#include "parallel/ClausesBuffer.h"
+#include "parallel/MultiSolvers.h"
+#include "simp/SimpSolver.h"
+
+using namespace Glucose;
+
+extern BoolOption opt_whenFullRemoveOlder;
+extern IntOption  opt_fifoSizeByCore;
+
+namespace {
+
+std::vector<std::vector<Lit>> RandomClauses(int n, int n_clauses, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::vector<Lit>> clauses;
+    for (int i = 0; i < n_clauses; ++i) {
+        std::vector<Lit> clause;
+        for (int j = 0; j < 3; ++j) clause.push_back(mkLit(rng() % n, rng() % 2));
+        clauses.push_back(clause);
+    }
+    return clauses;
+}
+
+// Each thread shares its clauses and reads those of the others, which must arrive complete and in
+// order. Without 'remove_older', a thread retries while its ring is full and every clause arrives;
+// otherwise, the clauses overwritten before they are read are skipped.
+void ExchangeClauses(bool remove_older, int fifo_size) {
+    const int n_threads = 4, n_clauses = 20000;
+    bool old_remove_older = opt_whenFullRemoveOlder;
+    int old_fifo_size = opt_fifoSizeByCore;
+    opt_whenFullRemoveOlder = remove_older;
+    opt_fifoSizeByCore = fifo_size;
+    ClausesBuffer buffer;
+    buffer.setNbThreads(n_threads);
+    opt_whenFullRemoveOlder = old_remove_older;
+    opt_fifoSizeByCore = old_fifo_size;
+
+    std::atomic<int> n_writers(n_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; ++t) {
+        threads.emplace_back([&buffer, &n_writers, remove_older, t]() {
+            ClauseAllocator ca;
+            std::vector<int> n_read(n_threads, 0); // Next clause expected from each thread
+            int n_pushed = 0, n_complete = 0;
+            vec<Lit> lits;
+            for (bool finished = false; !finished;) {
+                // With overwriting, some bursts are larger than the ring
+                for (int burst = remove_older ? 1 + n_pushed % 23 : 1; burst > 0 && n_pushed < n_clauses; --burst) {
+                    lits.clear();
+                    lits.push(mkLit(t));
+                    lits.push(mkLit(n_pushed));
+                    for (int i = 0; i < n_pushed % 9; ++i) lits.push(mkLit(i, true));
+                    CRef cr = ca.alloc(lits, false);
+                    bool pushed = buffer.pushClause(t, ca[cr]);
+                    ca.free(cr);
+                    if (!pushed) break;
+                    if (++n_pushed == n_clauses) --n_writers;
+                }
+                // With overwriting, the last read starts once all the clauses are written
+                bool last_read = remove_older && n_writers == 0;
+                int origin;
+                while (buffer.getClause(t, origin, lits)) {
+                    assert(origin != t && lits.size() >= 2 && lits[0] == mkLit(origin));
+                    int k = var(lits[1]);
+                    assert(remove_older ? k >= n_read[origin] : k == n_read[origin]);
+                    n_read[origin] = k + 1;
+                    assert(!sign(lits[1]) && lits.size() == 2 + k % 9);
+                    for (int i = 2; i < lits.size(); ++i) assert(lits[i] == mkLit(i - 2, true));
+                    if (n_read[origin] == n_clauses) ++n_complete;
+                }
+                finished = remove_older ? last_read : n_pushed == n_clauses && n_complete == n_threads - 1;
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+}
+
+// Solves a random 3-SAT instance over 'n' variables with 'M', and checks the result against
+// SimpSolver and the model (extended to the eliminated variables) against the clauses.
+void CheckRandomInstance(MultiSolvers& M, int n, unsigned seed) {
+    std::vector<std::vector<Lit>> clauses = RandomClauses(n, n * 43 / 10, seed);
+
+    SimpSolver S;
+    for (int i = 0; i < n; ++i) S.newVar(), M.newVar();
+    bool ok = true;
+    for (auto& clause : clauses) {
+        vec<Lit> ps;
+        for (Lit l : clause) ps.push(l);
+        S.addClause(ps);
+        ok &= M.addClause(ps);
+    }
+    lbool expected = S.solve() ? l_True : l_False;
+
+    lbool result = l_False;
+    if (ok && M.simplify() && M.eliminate() && M.okay())
+        result = M.solve();
+    assert(result == expected);
+    if (result == l_True) {
+        assert(M.model.size() == n);
+        for (auto& clause : clauses) {
+            bool sat = false;
+            for (Lit l : clause) sat |= M.model[var(l)] == (sign(l) ? l_False : l_True);
+            assert(sat);
+        }
+    }
+}
+
+}
+
+DEFINE_TEST(multi_solvers_random) {
+    for (unsigned seed = 0; seed < 8; ++seed) {
+        MultiSolvers M;
+        CheckRandomInstance(M, 80, seed);
+    }
+}
+
+DEFINE_TEST(multi_solvers_cubes) {
+    // Tiny budgets, so that some cubes are split and others refuted by lookahead
+    uint64_t n_split = 0, n_refuted = 0;
+    for (unsigned seed = 0; seed < 8; ++seed) {
+        MultiSolvers M;
+        M.use_cubes = true;
+        M.cube_budget = 1 + seed % 3 * 20;
+        M.lookahead_candidates = 1 + seed % 2 * 20;
+        CheckRandomInstance(M, 150, 100 + seed);
+        n_split += M.cubesSplit();
+        n_refuted += M.cubesRefuted();
+    }
+    assert(n_split > 0);
+    assert(n_refuted > 0);
+}
+
+DEFINE_TEST(multi_solvers_units_after_clones) {
+    // Units given once the clones are built go to every thread, and are propagated
+    MultiSolvers M;
+    for (int i = 0; i < 4; ++i) M.newVar();
+    vec<Lit> ps;
+    ps.push(mkLit(0)), ps.push(mkLit(1));
+    assert(M.addClause(ps));
+    ps.clear();
+    ps.push(mkLit(0)), ps.push(mkLit(1, true));
+    assert(M.addClause(ps));
+    M.generateAllSolvers();
+
+    ps.clear();
+    ps.push(mkLit(2));
+    assert(M.addClause(ps) && M.okay());
+    assert(M.getPrimarySolver()->value(2) == l_True);
+    ps.clear();
+    ps.push(mkLit(0, true));
+    assert(!M.addClause(ps) && !M.okay());
+}
+
+DEFINE_TEST(multi_solvers_constraints) {
+    // Pigeonhole problems with at-most-one constraints on the holes, only given to solver 0
+    for (int n_holes = 3; n_holes <= 6; ++n_holes) {
+        for (int n_pigeons = n_holes; n_pigeons <= n_holes + 1; ++n_pigeons) {
+            MultiSolvers M;
+            auto x = [&](int p, int h) { return mkLit(p * n_holes + h); };
+            for (int i = 0; i < n_pigeons * n_holes; ++i) M.newVar();
+            for (int p = 0; p < n_pigeons; ++p) {
+                vec<Lit> ps;
+                for (int h = 0; h < n_holes; ++h) ps.push(x(p, h));
+                M.addClause(ps);
+            }
+            for (int h = 0; h < n_holes; ++h) {
+                std::vector<Lit> lits;
+                for (int p = 0; p < n_pigeons; ++p) lits.push_back(x(p, h));
+                M.addConstraint(std::make_unique<AtMost>(std::move(lits), 1));
+            }
+            lbool result = M.simplify() && M.eliminate() && M.okay() ? M.solve() : l_False;
+            assert(result == (n_pigeons <= n_holes ? l_True : l_False));
+            if (result == l_True) {
+                for (int h = 0; h < n_holes; ++h) {
+                    int n = 0;
+                    for (int p = 0; p < n_pigeons; ++p) n += M.model[var(x(p, h))] == l_True;
+                    assert(n <= 1);
+                }
+            }
+        }
+    }
+}
+
+DEFINE_TEST(clauses_buffer_threads) {
+    ExchangeClauses(false, opt_fifoSizeByCore);
+    // A tiny ring, whose clauses are overwritten while they are read
+    ExchangeClauses(true, 64);
+}
+
+DEFINE_TEST(clause_filter) {
+    vec<Lit> a, b, tmp;
+    a.push(mkLit(3)), a.push(mkLit(1, true)), a.push(mkLit(7));
+    b.push(mkLit(7)), b.push(mkLit(3)), b.push(mkLit(1, true));
+    uint64_t h = ClauseFilter::hash(a, tmp);
+    assert(ClauseFilter::hash(b, tmp) == h);
+    b[0] = mkLit(7, true);
+    assert(ClauseFilter::hash(b, tmp) != h);
+
+    ClauseFilter filter;
+    filter.init(6); // 64 entries
+    assert(!filter.contains(h));
+    assert(filter.insert(h));
+    assert(!filter.insert(h));
+    assert(filter.contains(h));
+
+    // A clause is forgotten after as many other clauses as there are entries
+    for (int i = 0; i < 64; ++i) {
+        b.clear();
+        b.push(mkLit(100 + i));
+        assert(filter.insert(ClauseFilter::hash(b, tmp)));
+    }
+    assert(!filter.contains(h));
+    assert(filter.insert(h));
+}
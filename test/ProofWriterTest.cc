@@ -0,0 +1,328 @@
+// Enable assert() even on release build
+#undef NDEBUG
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test/Test.h"
+#include "core/ProofWriter.h"
+#include "core/Solver.h"
+#include "simp/SimpSolver.h"
+#include "constraints/AtMost.h"
+#include "constraints/Xor.h"
+
+using namespace Glucose;
+
+namespace {
+
+std::string WriteProof(bool binary, int n_clauses) {
+    FILE* f = tmpfile();
+    {
+        // Small blocks, to hand many of them to the writer thread
+        ProofWriter w(f, binary, 64, 2);
+        for (int i = 0; i < n_clauses; ++i) {
+            w.beginClause(i % 3 == 2);
+            w.addLit(mkLit(i % 200, i % 2));
+            w.addLit(mkLit(i * 7 % 100000, true));
+            w.endClause();
+        }
+    }
+    std::string ret;
+    rewind(f);
+    for (int c; (c = fgetc(f)) != EOF;) ret += (char)c;
+    fclose(f);
+    return ret;
+}
+
+void PutVarint(std::string& s, unsigned n) {
+    for (; n > 127; n >>= 7) s += (char)(128 | (n & 127));
+    s += (char)n;
+}
+
+// Whether 'lemma' follows from 'clauses' by unit propagation (DIMACS literals)
+bool IsRUP(int n_vars, const std::vector<std::vector<int>>& clauses, const std::vector<int>& lemma) {
+    std::vector<int> value(n_vars + 1, 0);
+    auto val = [&](int l) { return l > 0 ? value[l] : -value[-l]; };
+    for (int l : lemma) {
+        if (val(l) > 0) return true;
+        value[abs(l)] = l > 0 ? -1 : 1;
+    }
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const std::vector<int>& c : clauses) {
+            int n_undef = 0, unit = 0;
+            bool sat = false;
+            for (int l : c) {
+                if (val(l) > 0) sat = true;
+                else if (val(l) == 0) ++n_undef, unit = l;
+            }
+            if (sat) continue;
+            if (n_undef == 0) return true;
+            if (n_undef == 1) value[abs(unit)] = unit > 0 ? 1 : -1, changed = true;
+        }
+    }
+    return false;
+}
+
+// Checks the DRAT proof in the file 'name' (and removes it) against 'formula', except for the RAT
+// lemmas: each lemma must follow by unit propagation, and the empty clause must be derived.
+// Returns the number of lemmas which are clauses of the formula.
+int CheckDRAT(const char* name, int n_vars, std::vector<std::vector<int>> formula) {
+    FILE* f = fopen(name, "r");
+    std::string proof;
+    for (int c; (c = fgetc(f)) != EOF;) proof += (char)c;
+    fclose(f);
+    unlink(name);
+
+    for (std::vector<int>& c : formula) std::sort(c.begin(), c.end());
+    const std::vector<std::vector<int>> input = formula;
+    std::istringstream lines(proof);
+    std::string line;
+    int n_input_lemmas = 0;
+    bool empty_clause = false;
+    while (std::getline(lines, line)) {
+        std::istringstream in(line[0] == 'd' ? line.substr(1) : line);
+        std::vector<int> lemma;
+        for (int l; in >> l && l != 0;) lemma.push_back(l);
+        std::sort(lemma.begin(), lemma.end());
+        if (line[0] == 'd') {
+            auto it = std::find(formula.begin(), formula.end(), lemma);
+            assert(it != formula.end());
+            // Like DRAT checkers, keep the satisfied clauses that may imply top level units
+            bool satisfied = false;
+            for (int l : lemma) satisfied |= IsRUP(n_vars, formula, {l});
+            if (!satisfied) formula.erase(it);
+            continue;
+        }
+        assert(IsRUP(n_vars, formula, lemma));
+        n_input_lemmas += std::find(input.begin(), input.end(), lemma) != input.end();
+        formula.push_back(lemma);
+        empty_clause |= lemma.empty();
+    }
+    assert(empty_clause);
+    return n_input_lemmas;
+}
+
+}
+
+DEFINE_TEST(proof_writer_formats) {
+    std::string text, binary;
+    for (int i = 0; i < 5000; ++i) {
+        bool deletion = i % 3 == 2;
+        int a = i % 200 + 1, b = i * 7 % 100000 + 1;
+        text += std::string(deletion ? "d " : "") + std::to_string(i % 2 ? -a : a) + " " + std::to_string(-b) + " 0\n";
+        binary += deletion ? 'd' : 'a';
+        PutVarint(binary, 2 * a + i % 2);
+        PutVarint(binary, 2 * b + 1);
+        binary += (char)0;
+    }
+    assert(WriteProof(false, 5000) == text);
+    assert(WriteProof(true, 5000) == binary);
+}
+
+DEFINE_TEST(proof_constraint_explanations) {
+    // Pigeonhole problem with native at-most-one constraints on the holes, whose pairwise encoding
+    // is only given to the checker: the explanations of the constraints follow from it.
+    const int n_holes = 5, n_pigeons = 6;
+    auto x = [&](int p, int h) { return p * n_holes + h + 1; };
+    std::vector<std::vector<int>> formula;
+
+    char name[] = "/tmp/glucose_testXXXXXX";
+    close(mkstemp(name));
+    Solver S;
+    S.certifiedUNSAT = true;
+    S.certifiedOutput = fopen(name, "wb");
+    for (int i = 0; i < n_holes * n_pigeons; ++i) S.newVar();
+    for (int p = 0; p < n_pigeons; ++p) {
+        vec<Lit> c;
+        formula.emplace_back();
+        for (int h = 0; h < n_holes; ++h) {
+            c.push(mkLit(x(p, h) - 1));
+            formula.back().push_back(x(p, h));
+        }
+        S.addClause_(c);
+    }
+    for (int h = 0; h < n_holes; ++h) {
+        std::vector<Lit> lits;
+        for (int p = 0; p < n_pigeons; ++p) {
+            lits.push_back(mkLit(x(p, h) - 1));
+            for (int q = p + 1; q < n_pigeons; ++q) formula.push_back({-x(p, h), -x(q, h)});
+        }
+        S.addConstraint(std::make_unique<AtMost>(std::move(lits), 1), true);
+    }
+    assert(!S.solve());
+    S.closeProof(true);
+
+    // The explanations are the clauses of the encoding
+    assert(CheckDRAT(name, n_holes * n_pigeons, formula) > 0);
+}
+
+DEFINE_TEST(proof_xor_explanations) {
+    // Unsatisfiable system of XORs over 3 variables, whose direct encodings are only given to the
+    // checker. Each variable x(i) has a copy y(i), with the clauses (x(i) <-> y(i)), which takes
+    // its place in the last XORs: the solver must not substitute them in the constraints.
+    const int n = 12, n_xors = 20;
+    auto x = [&](int i) { return i + 1; };
+    auto y = [&](int i) { return n + i + 1; };
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        std::vector<std::vector<int>> xors;
+        unsigned rng = seed;
+        auto next = [&]() { return rng = rng * 1103515245 + 12345, (rng >> 16) % n; };
+        for (int k = 0; k < n_xors; ++k) {
+            int a = next(), b = next(), c = next();
+            if (a == b || b == c || a == c) { --k; continue; }
+            xors.push_back({a, b, c, (int)(next() & 1)});
+        }
+        // Brute force: only unsatisfiable systems give a proof
+        bool sat = false;
+        for (int mask = 0; mask < (1 << n) && !sat; ++mask) {
+            bool ok = true;
+            for (auto& v : xors) ok &= (((mask >> v[0]) ^ (mask >> v[1]) ^ (mask >> v[2])) & 1) == v[3];
+            sat = ok;
+        }
+        if (sat) continue;
+
+        std::vector<std::vector<int>> formula;
+        char name[] = "/tmp/glucose_testXXXXXX";
+        close(mkstemp(name));
+        SimpSolver S;
+        S.certifiedUNSAT = true;
+        S.certifiedOutput = fopen(name, "wb");
+        for (int i = 0; i < 2 * n; ++i) S.newVar();
+        for (int i = 0; i < n; ++i) {
+            formula.push_back({x(i), -y(i)});
+            formula.push_back({-x(i), y(i)});
+            S.addClause(mkLit(x(i) - 1), ~mkLit(y(i) - 1));
+            S.addClause(~mkLit(x(i) - 1), mkLit(y(i) - 1));
+        }
+        for (int k = 0; k < n_xors; ++k) {
+            std::vector<int> vars;
+            for (int j = 0; j < 3; ++j) vars.push_back(k < n_xors / 2 ? x(xors[k][j]) : y(xors[k][j]));
+            // The clauses forbidding the assignments of the wrong parity
+            for (int signs = 0; signs < 8; ++signs) {
+                if ((__builtin_popcount(signs) & 1) == xors[k][3]) continue;
+                formula.emplace_back();
+                for (int j = 0; j < 3; ++j) formula.back().push_back(signs >> j & 1 ? -vars[j] : vars[j]);
+            }
+            std::vector<Lit> lits;
+            for (int v : vars) lits.push_back(mkLit(v - 1));
+            S.addConstraint(std::make_unique<Xor>(lits, xors[k][3]), true);
+        }
+        assert(!S.solve());
+        S.closeProof(true);
+        CheckDRAT(name, 2 * n, formula);
+    }
+}
+
+namespace {
+
+// Solves 'formula' (which must be unsatisfiable) with an LRAT proof, and checks that the input
+// clauses have the IDs 1, 2, ... and that each lemma follows by unit propagation on its hints.
+void CheckLRAT(Solver& S, const std::vector<std::vector<int>>& formula, int n_vars) {
+    char name[] = "/tmp/glucose_testXXXXXX";
+    close(mkstemp(name));
+    S.certifiedUNSAT = true;
+    S.certifiedOutput = fopen(name, "wb");
+    S.useLRAT();
+    for (int i = 0; i < n_vars; ++i) S.newVar();
+    for (const std::vector<int>& c : formula) {
+        vec<Lit> lits;
+        for (int l : c) lits.push(mkLit(abs(l) - 1, l < 0));
+        S.addClause_(lits);
+    }
+    assert(!S.solve());
+
+    FILE* f = fopen(name, "r");
+    std::string proof;
+    for (int c; (c = fgetc(f)) != EOF;) proof += (char)c;
+    fclose(f);
+    unlink(name);
+
+    // Each lemma must follow by unit propagation on its hints, in order
+    std::map<long long, std::vector<int>> clauses;
+    for (size_t i = 0; i < formula.size(); ++i) clauses[i + 1] = formula[i];
+    std::istringstream lines(proof);
+    std::string line;
+    long long last_id = formula.size();
+    bool empty_clause = false;
+    while (std::getline(lines, line)) {
+        std::istringstream in(line);
+        long long id, n;
+        in >> id;
+        if (line.find('d') != std::string::npos) {
+            std::string d;
+            in >> d;
+            for (; in >> n && n != 0;) assert(clauses.erase(n) == 1);
+            continue;
+        }
+        assert(id > last_id);
+        last_id = id;
+        std::vector<int> lemma;
+        for (int l; in >> l && l != 0;) lemma.push_back(l);
+        std::vector<int> value(n_vars + 1, 0);
+        auto val = [&](int l) { return l > 0 ? value[l] : -value[-l]; };
+        for (int l : lemma) value[abs(l)] = l > 0 ? -1 : 1;
+        bool conflict = false;
+        for (; in >> n && n != 0;) {
+            assert(!conflict && clauses.count(n));
+            int n_undef = 0, unit = 0;
+            for (int l : clauses[n]) {
+                assert(val(l) <= 0);
+                if (val(l) == 0 && l != unit) ++n_undef, unit = l;
+            }
+            assert(n_undef <= 1);
+            if (n_undef == 0) conflict = true;
+            else value[abs(unit)] = unit > 0 ? 1 : -1;
+        }
+        assert(conflict);
+        clauses[id] = lemma;
+        empty_clause |= lemma.empty();
+    }
+    assert(empty_clause);
+}
+
+}
+
+DEFINE_TEST(proof_lrat) {
+    // Pigeonhole problem, in which the clauses of the pigeons also contain a duplicate literal and
+    // the literal ~y, with the unit clause y: their shortened versions are lemmas of the proof.
+    const int n_holes = 5, n_pigeons = 6, y = n_holes * n_pigeons + 1;
+    auto x = [&](int p, int h) { return p * n_holes + h + 1; };
+    std::vector<std::vector<int>> formula;
+    formula.push_back({y});
+    for (int p = 0; p < n_pigeons; ++p) {
+        formula.push_back({x(p, 0), -y});
+        for (int h = 0; h < n_holes; ++h) formula.back().push_back(x(p, h));
+    }
+    for (int h = 0; h < n_holes; ++h)
+        for (int p = 0; p < n_pigeons; ++p)
+            for (int q = p + 1; q < n_pigeons; ++q) formula.push_back({-x(p, h), -x(q, h)});
+
+    Solver S;
+    CheckLRAT(S, formula, y);
+}
+
+DEFINE_TEST(proof_lrat_contradictory_input) {
+    // The clauses added after the contradiction (and, with use_rcheck, those found implied) still
+    // take their IDs, before the IDs of the lemmas
+    const std::vector<std::vector<int>> formula = {
+        {-1, 2}, {-2, 3}, {-1, 3}, {1}, {-3}, {4, 5}, {-4, 6}, {-5}, {1, 6}, {-6}};
+    {
+        Solver S;
+        CheckLRAT(S, formula, 6);
+    }
+    {
+        SimpSolver S;
+        S.use_rcheck = true;
+        CheckLRAT(S, formula, 6);
+    }
+}
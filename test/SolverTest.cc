@@ -0,0 +1,565 @@
+// Enable assert() even on release build
+#undef NDEBUG
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <functional>
+#include <random>
+
+#include "test/Test.h"
+#include "test/TestUtil.h"
+#include "constraints/AtMost.h"
+#include "constraints/Xor.h"
+#include "simp/SimpSolver.h"
+
+using namespace Glucose;
+
+namespace {
+
+struct RandomInstance {
+    int n;
+    std::vector<std::vector<Lit>> clauses;
+    std::vector<std::pair<std::vector<Lit>, int>> atMosts;
+};
+
+RandomInstance GenerateInstance(int n, int nClauses, int nAtMosts, unsigned seed) {
+    std::mt19937 rng(seed);
+    RandomInstance inst;
+    inst.n = n;
+    for (int i = 0; i < nClauses; ++i) {
+        std::vector<Lit> clause;
+        for (int j = 0; j < 3; ++j) {
+            clause.push_back(mkLit(rng() % n, rng() % 2));
+        }
+        inst.clauses.push_back(clause);
+    }
+    for (int i = 0; i < nAtMosts; ++i) {
+        std::vector<Lit> lits;
+        std::vector<bool> used(n, false);
+        for (int j = 0; j < 5; ++j) {
+            Var v = rng() % n;
+            if (used[v]) continue;
+            used[v] = true;
+            lits.push_back(mkLit(v, rng() % 2));
+        }
+        inst.atMosts.push_back({lits, (int)(rng() % 3)});
+    }
+    return inst;
+}
+
+int CountBruteForce(const RandomInstance& inst) {
+    int ret = 0;
+    for (int mask = 0; mask < (1 << inst.n); ++mask) {
+        auto value = [&](Lit l) { return (bool)((mask >> var(l)) & 1) != sign(l); };
+        bool ok = true;
+        for (auto& clause : inst.clauses) {
+            bool sat = false;
+            for (Lit l : clause) sat |= value(l);
+            ok &= sat;
+        }
+        for (auto& [lits, k] : inst.atMosts) {
+            int cnt = 0;
+            for (Lit l : lits) cnt += value(l);
+            ok &= cnt <= k;
+        }
+        if (ok) ++ret;
+    }
+    return ret;
+}
+
+int CountWithSolver(const RandomInstance& inst, const std::function<void(Solver&)>& configure) {
+    Solver S;
+    configure(S);
+
+    std::vector<Var> vars;
+    for (int i = 0; i < inst.n; ++i) {
+        vars.push_back(S.newVar());
+    }
+    for (auto& clause : inst.clauses) {
+        vec<Lit> ps;
+        for (Lit l : clause) ps.push(l);
+        S.addClause(ps);
+    }
+    for (auto& [lits, k] : inst.atMosts) {
+        S.addConstraint(std::make_unique<AtMost>(std::vector<Lit>(lits), k));
+    }
+    return CountNumAssignment(S, vars);
+}
+
+void CheckRandomInstances(const std::function<void(Solver&)>& configure) {
+    for (unsigned seed = 0; seed < 30; ++seed) {
+        RandomInstance inst = GenerateInstance(12, 30 + seed % 20, seed % 4, seed);
+        assert(CountWithSolver(inst, configure) == CountBruteForce(inst));
+    }
+}
+
+// Instances too large to count: the configured solver must agree with the default one and give
+// models. Returns the sum of the statistics of the configured solvers.
+std::vector<uint64_t> CheckLargeInstances(const std::function<void(Solver&)>& configure, int nBinaries = 0) {
+    std::vector<uint64_t> stats(coreStatsSize);
+    for (unsigned seed = 0; seed < 8; ++seed) {
+        RandomInstance inst = GenerateInstance(150, 540 + 10 * seed, seed % 4, seed);
+        std::mt19937 rng(seed);
+        for (int i = 0; i < nBinaries; ++i) {
+            inst.clauses.push_back({mkLit(rng() % inst.n, rng() % 2), mkLit(rng() % inst.n, rng() % 2)});
+        }
+        bool expected;
+        for (int configured = 0; configured < 2; ++configured) {
+            Solver S;
+            S.verbosity = 0;
+            if (configured) configure(S);
+            for (int i = 0; i < inst.n; ++i) S.newVar();
+            for (auto& clause : inst.clauses) {
+                vec<Lit> ps;
+                for (Lit l : clause) ps.push(l);
+                S.addClause(ps);
+            }
+            for (auto& [lits, k] : inst.atMosts) {
+                S.addConstraint(std::make_unique<AtMost>(std::vector<Lit>(lits), k));
+            }
+            bool res = S.solve();
+            if (!configured) {
+                expected = res;
+                continue;
+            }
+            assert(res == expected);
+            for (int i = 0; i < coreStatsSize; ++i) stats[i] += S.stats[i];
+            if (!res) continue;
+            for (auto& clause : inst.clauses) {
+                bool sat = false;
+                for (Lit l : clause) sat |= S.modelValue(l) == l_True;
+                assert(sat);
+            }
+            for (auto& [lits, k] : inst.atMosts) {
+                int cnt = 0;
+                for (Lit l : lits) cnt += S.modelValue(l) == l_True;
+                assert(cnt <= k);
+            }
+        }
+    }
+    return stats;
+}
+
+}
+
+DEFINE_TEST(solver_chrono_backtrack) {
+    auto configure = [](Solver& S) {
+        S.chrono = 0;
+        S.confl_to_chrono = 0;
+    };
+    CheckRandomInstances(configure);
+    std::vector<uint64_t> stats = CheckLargeInstances(configure);
+    assert(stats[nbChronoBT] > 0);
+}
+
+DEFINE_TEST(solver_trail_saving) {
+    auto configure = [](Solver& S) {
+        S.trail_saving = true;
+    };
+    auto configure_chrono = [](Solver& S) {
+        S.trail_saving = true;
+        S.chrono = 0;
+        S.confl_to_chrono = 0;
+    };
+    CheckRandomInstances(configure);
+    CheckRandomInstances(configure_chrono);
+    std::vector<uint64_t> stats = CheckLargeInstances(configure);
+    assert(stats[nbTrailReplayed] > 0);
+    stats = CheckLargeInstances(configure_chrono);
+    assert(stats[nbTrailReplayed] > 0);
+}
+
+DEFINE_TEST(solver_vmtf) {
+    auto configure = [](Solver& S) {
+        S.vmtf = true;
+    };
+    auto configure_chrono = [](Solver& S) {
+        S.vmtf = true;
+        S.chrono = 0;
+        S.confl_to_chrono = 0;
+    };
+    CheckRandomInstances(configure);
+    CheckRandomInstances(configure_chrono);
+
+    // Conflicts above level 0 bump variables in the queue
+    std::vector<uint64_t> stats = CheckLargeInstances(configure);
+    assert(stats[sumDecisionLevels] > 0);
+    stats = CheckLargeInstances(configure_chrono);
+    assert(stats[sumDecisionLevels] > 0);
+    assert(stats[nbChronoBT] > 0);
+}
+
+DEFINE_TEST(solver_vmtf_switch) {
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        RandomInstance inst = GenerateInstance(12, 40, 2, seed);
+        int expected = CountBruteForce(inst);
+        for (int initial = 0; initial < 2; ++initial) {
+            Solver S;
+            S.vmtf = initial;
+            std::vector<Var> vars;
+            for (int i = 0; i < inst.n; ++i) {
+                vars.push_back(S.newVar());
+            }
+            for (auto& clause : inst.clauses) {
+                vec<Lit> ps;
+                for (Lit l : clause) ps.push(l);
+                S.addClause(ps);
+            }
+            for (auto& [lits, k] : inst.atMosts) {
+                S.addConstraint(std::make_unique<AtMost>(std::vector<Lit>(lits), k));
+            }
+            S.solve();
+            S.setVMTF(!initial);
+            assert(CountNumAssignment(S, vars) == expected);
+        }
+    }
+}
+
+DEFINE_TEST(solver_clone_constraints) {
+    for (unsigned seed = 0; seed < 20; ++seed) {
+        RandomInstance inst = GenerateInstance(12, 30 + seed % 10, 1 + seed % 3, seed);
+        int expected = CountBruteForce(inst);
+        std::unique_ptr<Solver> clone;
+        std::vector<Var> vars;
+        {
+            Solver S;
+            for (int i = 0; i < inst.n; ++i) {
+                vars.push_back(S.newVar());
+            }
+            for (auto& clause : inst.clauses) {
+                vec<Lit> ps;
+                for (Lit l : clause) ps.push(l);
+                S.addClause(ps);
+            }
+            for (auto& [lits, k] : inst.atMosts) {
+                S.addConstraint(std::make_unique<AtMost>(std::vector<Lit>(lits), k));
+            }
+            clone.reset(static_cast<Solver*>(S.clone()));
+            // The original is searched and destroyed: the clone must not share its constraints
+            S.solve();
+        }
+        assert(CountNumAssignment(*clone, vars) == expected);
+    }
+}
+
+DEFINE_TEST(solver_constraint_without_clone) {
+    // A constraint keeping the default clone() can be solved, but not copied
+    struct UncloneableAtMost : AtMost {
+        using AtMost::AtMost;
+        std::unique_ptr<Constraint> clone() const override { return Constraint::clone(); }
+    };
+    RandomInstance inst = GenerateInstance(12, 30, 0, 0);
+    inst.atMosts.push_back({{mkLit(0), mkLit(1), mkLit(2)}, 1});
+    int expected = CountBruteForce(inst);
+
+    Solver S;
+    S.verbosity = 0;
+    std::vector<Var> vars;
+    for (int i = 0; i < inst.n; ++i) vars.push_back(S.newVar());
+    for (auto& clause : inst.clauses) {
+        vec<Lit> ps;
+        for (Lit l : clause) ps.push(l);
+        S.addClause(ps);
+    }
+    S.addConstraint(std::make_unique<UncloneableAtMost>(std::vector<Lit>(inst.atMosts[0].first), 1));
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        fclose(stderr);
+        S.clone();
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 1);
+
+    assert(CountNumAssignment(S, vars) == expected);
+}
+
+DEFINE_TEST(solver_stable_mode) {
+    auto configure = [](Solver& S) {
+        S.stable_mode_switching = true;
+        S.stable_init = 1;
+        S.rephase_int = 1;
+    };
+    CheckRandomInstances(configure);
+    std::vector<uint64_t> stats = CheckLargeInstances(configure);
+    assert(stats[nbModeSwitches] > 0);
+    assert(stats[nbRephases] > 0);
+}
+
+DEFINE_TEST(solver_vivify) {
+    auto configure = [](Solver& S) {
+        S.vivify = true;
+        S.vivify_int = 1;
+        S.vivify_eff = 100;
+    };
+    CheckRandomInstances(configure);
+    std::vector<uint64_t> stats = CheckLargeInstances(configure);
+    assert(stats[nbVivifiedClauses] > 0);
+    assert(stats[nbVivifiedLits] > 0);
+}
+
+DEFINE_TEST(solver_probing) {
+    auto configure = [](Solver& S) {
+        S.probing = true;
+        S.probe_int = 1;
+    };
+    CheckRandomInstances(configure);
+    std::vector<uint64_t> stats = CheckLargeInstances(configure, 15);
+    assert(stats[nbProbes] > 0);
+    assert(stats[nbHyperBinaries] > 0);
+
+    // Binary clauses give roots to probe
+    for (unsigned seed = 0; seed < 30; ++seed) {
+        RandomInstance inst = GenerateInstance(12, 15 + seed % 10, seed % 3, seed);
+        std::mt19937 rng(seed);
+        for (int i = 0; i < 8; ++i) {
+            inst.clauses.push_back({mkLit(rng() % inst.n, rng() % 2), mkLit(rng() % inst.n, rng() % 2)});
+        }
+        assert(CountWithSolver(inst, configure) == CountBruteForce(inst));
+    }
+}
+
+DEFINE_TEST(simp_solver_inprocessing) {
+    int rounds = 0, subsumed_learnts = 0;
+    for (unsigned seed = 0; seed < 8; ++seed) {
+        RandomInstance inst = GenerateInstance(150, 630, 0, seed);
+        bool expected;
+        {
+            Solver S;
+            S.verbosity = 0;
+            for (int i = 0; i < inst.n; ++i) S.newVar();
+            for (auto& clause : inst.clauses) {
+                vec<Lit> ps;
+                for (Lit l : clause) ps.push(l);
+                S.addClause(ps);
+            }
+            expected = S.solve();
+        }
+
+        SimpSolver S;
+        S.verbosity = 0;
+        S.use_inprocessing = true;
+        S.inprocess_int = 1;
+        S.inprocess_units = 1;
+        for (int i = 0; i < inst.n; ++i) S.newVar();
+        for (auto& clause : inst.clauses) {
+            vec<Lit> ps;
+            for (Lit l : clause) ps.push(l);
+            S.addClause(ps);
+        }
+        S.eliminate(true);
+
+        // Solve twice, fixing some variables in between to trigger more elimination
+        for (int iter = 0; iter < 2; ++iter) {
+            bool res = S.solve();
+            assert(res == (expected || iter > 0));
+            if (!res) break;
+            for (auto& clause : inst.clauses) {
+                bool sat = false;
+                for (Lit l : clause) sat |= S.modelValue(l) == l_True;
+                assert(sat);
+            }
+            for (Var v = 0; v < inst.n / 3; ++v) {
+                if (!S.isEliminated(v)) S.addClause(mkLit(v, S.modelValue(v) == l_False));
+            }
+        }
+        rounds += S.inprocessings;
+        subsumed_learnts += S.subsumed_learnts;
+    }
+    assert(rounds > 0);
+    assert(subsumed_learnts > 0);
+}
+
+DEFINE_TEST(solver_add_clauses) {
+    for (unsigned seed = 0; seed < 30; ++seed) {
+        RandomInstance inst = GenerateInstance(12, 30 + seed % 20, 0, seed);
+        inst.clauses.insert(inst.clauses.begin() + seed % 10, {mkLit(seed % 12, seed % 3 == 0)});
+        int expected = CountBruteForce(inst);
+
+        for (int simp = 0; simp < 2; ++simp) {
+            SimpSolver S;
+            S.verbosity = 0;
+            std::vector<Var> vars;
+            for (int i = 0, first = S.newVars(inst.n); i < inst.n; ++i) {
+                vars.push_back(first + i);
+                S.setFrozen(first + i, true);
+            }
+            if (!simp) S.eliminate(true);
+
+            // In two batches, the units of the first one simplifying the second one
+            std::vector<Lit> lits;
+            std::vector<uint32_t> offsets{0};
+            for (auto& clause : inst.clauses) {
+                lits.insert(lits.end(), clause.begin(), clause.end());
+                offsets.push_back(lits.size());
+            }
+            int half = inst.clauses.size() / 2;
+            S.addClauses(lits.data(), offsets.data(), half);
+            S.addClauses(lits.data(), offsets.data() + half, inst.clauses.size() - half);
+            assert(CountNumAssignment(S, vars) == expected);
+        }
+    }
+}
+
+DEFINE_TEST(simp_solver_elim_threads) {
+    for (unsigned seed = 0; seed < 9; ++seed) {
+        // The last instance spans several batches of candidates
+        RandomInstance inst = seed < 8 ? GenerateInstance(150, 500 + 20 * seed, 0, seed)
+                                       : GenerateInstance(3000, 9000, 0, seed);
+        bool expected;
+        {
+            Solver S;
+            S.verbosity = 0;
+            for (int i = 0; i < inst.n; ++i) S.newVar();
+            for (auto& clause : inst.clauses) {
+                vec<Lit> ps;
+                for (Lit l : clause) ps.push(l);
+                S.addClause(ps);
+            }
+            expected = S.solve();
+        }
+
+        // The result of the elimination does not depend on the number of threads, but may differ
+        // from the sequential elimination (1 thread), which is only checked for the answer
+        int n_clauses = -1, n_eliminated = -1;
+        for (int threads : {1, 2, 4}) {
+            SimpSolver S;
+            S.verbosity = 0;
+            S.elim_threads = threads;
+            for (int i = 0; i < inst.n; ++i) S.newVar();
+            for (auto& clause : inst.clauses) {
+                vec<Lit> ps;
+                for (Lit l : clause) ps.push(l);
+                S.addClause(ps);
+            }
+            bool res = S.eliminate(true);
+            assert(S.eliminated_vars > 0);
+            if (threads > 1) {
+                if (n_clauses >= 0) {
+                    assert(S.nClauses() == n_clauses);
+                    assert(S.eliminated_vars == n_eliminated);
+                }
+                n_clauses = S.nClauses();
+                n_eliminated = S.eliminated_vars;
+            }
+
+            res = res && S.solve();
+            assert(res == expected);
+            if (!res) continue;
+            for (auto& clause : inst.clauses) {
+                bool sat = false;
+                for (Lit l : clause) sat |= S.modelValue(l) == l_True;
+                assert(sat);
+            }
+        }
+    }
+}
+
+DEFINE_TEST(simp_solver_substitution) {
+    for (unsigned seed = 0; seed < 30; ++seed) {
+        RandomInstance inst = GenerateInstance(12, 20 + seed % 10, 0, seed);
+        std::mt19937 rng(seed);
+        for (int i = 0; i < 4; ++i) {
+            Lit a = mkLit(rng() % inst.n, rng() % 2);
+            Lit b = mkLit(rng() % inst.n, rng() % 2);
+            inst.clauses.push_back({a, ~b});
+            inst.clauses.push_back({~a, b});
+        }
+        bool expected = CountBruteForce(inst) > 0;
+
+        SimpSolver S;
+        S.verbosity = 0;
+        for (int i = 0; i < inst.n; ++i) S.newVar();
+        for (auto& clause : inst.clauses) {
+            vec<Lit> ps;
+            for (Lit l : clause) ps.push(l);
+            S.addClause(ps);
+        }
+        S.use_elim = false;
+        bool res = S.eliminate(true) && S.solve();
+        assert(res == expected);
+        assert(!expected || S.substituted_vars > 0);
+        if (res) {
+            for (auto& clause : inst.clauses) {
+                bool sat = false;
+                for (Lit l : clause) sat |= S.modelValue(l) == l_True;
+                assert(sat);
+            }
+        }
+    }
+}
+
+DEFINE_TEST(simp_solver_constraints) {
+    // Variables of constraints are frozen automatically, or substituted in Xor constraints
+    int substituted = 0;
+    for (unsigned seed = 0; seed < 40; ++seed) {
+        RandomInstance inst = GenerateInstance(12, 10 + seed % 10, 2, seed);
+        std::mt19937 rng(seed);
+        std::vector<Lit> xor_lits;
+        for (int i = 0; i < 4; ++i) xor_lits.push_back(mkLit(rng() % inst.n, rng() % 2));
+        int parity = rng() % 2;
+        for (int i = 0; i < 3; ++i) {
+            Lit a = mkLit(rng() % inst.n, rng() % 2);
+            Lit b = xor_lits[i];
+            inst.clauses.push_back({a, ~b});
+            inst.clauses.push_back({~a, b});
+        }
+
+        auto xorSatisfied = [&](const std::function<bool(Lit)>& value) {
+            int p = 0;
+            for (Lit l : xor_lits) p ^= value(l);
+            return p == parity;
+        };
+        bool expected = false;
+        for (int mask = 0; mask < (1 << inst.n) && !expected; ++mask) {
+            auto value = [&](Lit l) { return (bool)((mask >> var(l)) & 1) != sign(l); };
+            bool ok = xorSatisfied(value);
+            for (auto& clause : inst.clauses) {
+                bool sat = false;
+                for (Lit l : clause) sat |= value(l);
+                ok &= sat;
+            }
+            for (auto& [lits, k] : inst.atMosts) {
+                int cnt = 0;
+                for (Lit l : lits) cnt += value(l);
+                ok &= cnt <= k;
+            }
+            expected = ok;
+        }
+
+        SimpSolver S;
+        S.verbosity = 0;
+        for (int i = 0; i < inst.n; ++i) S.newVar();
+        for (auto& clause : inst.clauses) {
+            vec<Lit> ps;
+            for (Lit l : clause) ps.push(l);
+            S.addClause(ps);
+        }
+        for (auto& [lits, k] : inst.atMosts) {
+            S.addConstraint(std::make_unique<AtMost>(std::vector<Lit>(lits), k));
+        }
+        S.addConstraint(std::make_unique<Xor>(xor_lits, parity));
+        bool res = S.eliminate(true) && S.solve();
+        assert(res == expected);
+        substituted += S.substituted_vars;
+        if (!res) continue;
+
+        auto value = [&](Lit l) { return S.modelValue(l) == l_True; };
+        for (auto& clause : inst.clauses) {
+            bool sat = false;
+            for (Lit l : clause) sat |= value(l);
+            assert(sat);
+        }
+        for (auto& [lits, k] : inst.atMosts) {
+            int cnt = 0;
+            for (Lit l : lits) cnt += value(l);
+            assert(cnt <= k);
+        }
+        assert(xorSatisfied(value));
+    }
+    assert(substituted > 0);
+}
@@ -0,0 +1,229 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef USE_LZMA
+#include <lzma.h>
+#endif
+
+#include "utils/InputFile.h"
+
+using namespace Glucose;
+
+static const size_t block_size = 1 << 20;
+
+// Reads 'n' bytes, or less at the end of the input.
+static size_t readFully(int fd, char* dst, size_t n)
+{
+    size_t done = 0;
+    while (done < n){
+        ssize_t r = read(fd, dst + done, n - done);
+        if (r <= 0) break;
+        done += r;
+    }
+    return done;
+}
+
+
+InputFile::InputFile(const char* filename)
+  : fd(filename == NULL ? 0 : open(filename, O_RDONLY)), format(Plain), eof(false)
+  , map(NULL), map_size(0), buf(NULL), buf_cap(0)
+  , raw(NULL), raw_pos(0), raw_size(0), raw_eof(false), stream(NULL)
+  , win_begin(NULL), win_end(NULL)
+{
+    if (fd < 0) return;
+
+    // Regular files are mapped, other inputs are read by blocks:
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0){
+#ifdef MAP_POPULATE
+        void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+#else
+        void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+#endif
+        if (p != MAP_FAILED){
+            map      = (char*)p;
+            map_size = st.st_size;
+            madvise(map, map_size, MADV_SEQUENTIAL);
+        }
+    }
+
+    const char* head;
+    size_t      head_size;
+    if (map != NULL){
+        head      = map;
+        head_size = map_size;
+    }else{
+        buf_cap   = block_size;
+        buf       = (char*)malloc(buf_cap);
+        head_size = readFully(fd, buf, buf_cap);
+        head      = buf;
+    }
+
+    bool gzip = head_size >= 2 && (unsigned char)head[0] == 0x1f && (unsigned char)head[1] == 0x8b;
+    bool xz   = head_size >= 6 && memcmp(head, "\xfd" "7zXZ", 6) == 0;
+
+    if (!gzip && !xz){
+        format    = map != NULL ? Mapped : Plain;
+        eof       = map != NULL || head_size < buf_cap;
+        win_begin = head;
+        win_end   = head + head_size;
+        return;
+    }
+
+    // Compressed input: what was read so far is the beginning of the compressed data.
+    if (map != NULL){
+        raw       = map;
+        raw_size  = map_size;
+        raw_eof   = true;
+        buf_cap   = block_size;
+        buf       = (char*)malloc(buf_cap);
+    }else{
+        raw       = buf;
+        raw_size  = head_size;
+        raw_eof   = head_size < buf_cap;
+        buf       = (char*)malloc(buf_cap);
+    }
+
+    if (gzip){
+#ifdef USE_ZLIB
+        format = Gzip;
+        z_stream* zs = (z_stream*)calloc(1, sizeof(z_stream));
+        if (inflateInit2(zs, 16 + MAX_WBITS) != Z_OK)
+            fprintf(stderr, "ERROR! Could not initialize zlib.\n"), exit(1);
+        stream = zs;
+#else
+        fprintf(stderr, "ERROR! Reading gzip files is not supported by this build (USE_ZLIB).\n"), exit(1);
+#endif
+    }else{
+#ifdef USE_LZMA
+        format = Xz;
+        lzma_stream* ls = (lzma_stream*)malloc(sizeof(lzma_stream));
+        *ls = LZMA_STREAM_INIT;
+        if (lzma_stream_decoder(ls, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+            fprintf(stderr, "ERROR! Could not initialize liblzma.\n"), exit(1);
+        stream = ls;
+#else
+        fprintf(stderr, "ERROR! Reading xz files is not supported by this build (USE_LZMA).\n"), exit(1);
+#endif
+    }
+
+    win_begin = win_end = buf;
+    refill(buf);
+}
+
+
+InputFile::~InputFile()
+{
+#ifdef USE_ZLIB
+    if (format == Gzip){
+        inflateEnd((z_stream*)stream);
+        free(stream); }
+#endif
+#ifdef USE_LZMA
+    if (format == Xz){
+        lzma_end((lzma_stream*)stream);
+        free(stream); }
+#endif
+    if (map != NULL)
+        munmap(map, map_size);
+    else
+        free(raw);
+    free(buf);
+    if (fd > 0)
+        close(fd);
+}
+
+
+size_t InputFile::readRaw(char* dst, size_t n)
+{
+    size_t r = readFully(fd, dst, n);
+    eof = r < n;
+    return r;
+}
+
+
+// Decompresses up to 'n' bytes, reading more compressed data as needed.
+size_t InputFile::decompress(char* dst, size_t n)
+{
+    size_t done = 0;
+    while (done == 0 && !eof){
+        if (raw_pos == raw_size && !raw_eof){
+            raw_size = readFully(fd, raw, block_size);
+            raw_pos  = 0;
+            raw_eof  = raw_size < block_size;
+        }
+        size_t avail = raw_size - raw_pos;
+        bool   error = false;
+
+#ifdef USE_ZLIB
+        if (format == Gzip){
+            z_stream* zs = (z_stream*)stream;
+            zs->next_in   = (Bytef*)raw + raw_pos;
+            zs->avail_in  = avail;
+            zs->next_out  = (Bytef*)dst;
+            zs->avail_out = n;
+            int ret = inflate(zs, Z_NO_FLUSH);
+            raw_pos = raw_size - zs->avail_in;
+            done    = n - zs->avail_out;
+            if (ret == Z_STREAM_END){
+                // Concatenated gzip members are read as one stream:
+                if (raw_pos == raw_size && !raw_eof){
+                    raw_size = readFully(fd, raw, block_size);
+                    raw_pos  = 0;
+                    raw_eof  = raw_size < block_size; }
+                if (raw_pos < raw_size) inflateReset(zs);
+                else                    eof = true;
+            }else if (ret != Z_OK && !(ret == Z_BUF_ERROR && avail == 0 && !raw_eof))
+                error = true;
+        }
+#endif
+#ifdef USE_LZMA
+        if (format == Xz){
+            lzma_stream* ls = (lzma_stream*)stream;
+            ls->next_in   = (const uint8_t*)raw + raw_pos;
+            ls->avail_in  = avail;
+            ls->next_out  = (uint8_t*)dst;
+            ls->avail_out = n;
+            lzma_ret ret = lzma_code(ls, raw_eof ? LZMA_FINISH : LZMA_RUN);
+            raw_pos = raw_size - ls->avail_in;
+            done    = n - ls->avail_out;
+            if (ret == LZMA_STREAM_END)
+                eof = true;
+            else if (ret != LZMA_OK)
+                error = true;
+        }
+#endif
+        if (error || (done == 0 && raw_eof && raw_pos == raw_size && !eof))
+            fprintf(stderr, "ERROR! Corrupted or truncated compressed input.\n"), exit(3);
+    }
+    return done;
+}
+
+
+bool InputFile::refill(const char* p)
+{
+    if (eof) return false;
+
+    size_t keep = win_end - p;
+    if (keep + block_size > buf_cap){
+        buf_cap = keep + block_size;
+        char* b = (char*)malloc(buf_cap);
+        memcpy(b, p, keep);
+        free(buf);
+        buf = b;
+    }else
+        memmove(buf, p, keep);
+
+    size_t n  = format == Plain ? readRaw(buf + keep, block_size) : decompress(buf + keep, block_size);
+    win_begin = buf;
+    win_end   = buf + keep + n;
+    return n > 0;
+}
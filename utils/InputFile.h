@@ -0,0 +1,61 @@
+#ifndef Glucose_InputFile_h
+#define Glucose_InputFile_h
+
+#include <stddef.h>
+
+namespace Glucose {
+
+//-------------------------------------------------------------------------------------------------
+// Input file, possibly compressed. Regular plain files are memory-mapped; pipes and the standard
+// input are read by blocks. Files compressed with gzip or xz (recognized by their first bytes) are
+// decompressed by blocks, when the library is available (USE_ZLIB and USE_LZMA).
+//
+// The data is accessed through a window ['begin()', 'end()'), which 'refill()' moves forward.
+
+class InputFile {
+public:
+    explicit InputFile(const char* filename);  // NULL means the standard input
+    ~InputFile();
+
+    bool        isOpen () const { return fd >= 0; }
+    const char* begin  () const { return win_begin; }
+    const char* end    () const { return win_end; }
+    bool        isMapped() const { return format == Mapped; }  // The window is the whole input
+
+    // Drops the data before 'p' (in the window) and reads more data after 'end()'. Returns FALSE
+    // if the end of the input was reached already.
+    bool        refill (const char* p);
+
+private:
+    enum Format { Plain, Mapped, Gzip, Xz };
+
+    size_t      readRaw    (char* dst, size_t n);  // Reads from 'fd', after the bytes kept in 'raw'
+    size_t      decompress (char* dst, size_t n);
+
+    int         fd;
+    Format      format;
+    bool        eof;
+
+    char*       map;          // Memory-mapped file
+    size_t      map_size;
+
+    char*       buf;          // Window of the decompressed data (when not mapped)
+    size_t      buf_cap;
+
+    char*       raw;          // Compressed data not consumed yet
+    size_t      raw_pos;
+    size_t      raw_size;
+    bool        raw_eof;
+    void*       stream;       // 'z_stream' or 'lzma_stream'
+
+    const char* win_begin;
+    const char* win_end;
+
+    InputFile(const InputFile&);
+    InputFile& operator=(const InputFile&);
+};
+
+//=================================================================================================
+}
+
+#endif
@@ -23,8 +23,12 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
+#include "mtl/IntTypes.h"
+#include "utils/InputFile.h"
+
 #ifdef USE_ZLIB
 #include <zlib.h>
 #else
@@ -60,10 +64,72 @@ public:
 
 
 //-------------------------------------------------------------------------------------------------
-// End-of-file detection functions for StreamBuffer and char*:
+// A character stream over the window of an 'InputFile':
+
+
+class InputBuffer {
+    InputFile&  in;
+    const char* pos;
+    const char* end;
+
+    bool refill() {
+        if (!in.refill(pos)) return false;
+        pos = in.begin();
+        end = in.end();
+        return true; }
+
+public:
+    explicit InputBuffer(InputFile& i) : in(i), pos(i.begin()), end(i.end()) {}
+
+    int  operator *  () const { return (pos >= end) ? EOF : (unsigned char)*pos; }
+    void operator ++ ()       { if (++pos >= end) refill(); }
+
+    // Direct access to the next 'n' characters, if the input does not end before:
+    bool        lookahead(int n) { if (end - pos < n) refill(); return end - pos >= n; }
+    const char* data     () const { return pos; }
+    void        skip     (int n)  { pos += n; if (pos >= end) refill(); }
+
+    void skipWhitespace() {
+        for (;;){
+            while (pos < end && ((*pos >= 9 && *pos <= 13) || *pos == 32))
+                pos++;
+            if (pos < end || !refill()) return; } }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// A character stream over the part ['begin', 'end') of data in memory, which may be read ahead
+// up to 'limit':
+
+
+class MemoryBuffer {
+    const char* pos;
+    const char* end;
+    const char* limit;
+
+public:
+    MemoryBuffer(const char* b, const char* e, const char* l) : pos(b), end(e), limit(l) {}
+
+    int  operator *  () const { return (pos >= end) ? EOF : (unsigned char)*pos; }
+    void operator ++ ()       { pos++; }
+
+    bool        lookahead(int n) const { return limit - pos >= n; }
+    const char* data     () const { return pos; }
+    void        skip     (int n)  { pos += n; }
+
+    void skipWhitespace() {
+        while (pos < end && ((*pos >= 9 && *pos <= 13) || *pos == 32))
+            pos++; }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// End-of-file detection functions for the buffers and char*:
 
 
 static inline bool isEof(StreamBuffer& in) { return *in == EOF;  }
+static inline bool isEof(InputBuffer&  in) { return *in == EOF;  }
+static inline bool isEof(MemoryBuffer& in) { return *in == EOF;  }
 static inline bool isEof(const char*   in) { return *in == '\0'; }
 
 //-------------------------------------------------------------------------------------------------
@@ -126,6 +192,56 @@ static int parseInt(B& in) {
     return neg ? -val : val; }
 
 
+static inline void skipWhitespace(InputBuffer&  in) { in.skipWhitespace(); }
+static inline void skipWhitespace(MemoryBuffer& in) { in.skipWhitespace(); }
+
+
+// Same as above, reading the digits 8 at a time from the window of the buffer.
+template<class B>
+static inline int parseIntWindow(B& in) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    skipWhitespace(in);
+    if (*in == EOF || !in.lookahead(32))
+        return parseInt<B>(in);
+
+    static const uint64_t pow10[9] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+    const char* p   = in.data();
+    bool        neg = false;
+    if      (*p == '-') neg = true, p++;
+    else if (*p == '+') p++;
+
+    const char* digits = p;
+    uint64_t    val    = 0;
+    for (int i = 0; i < 3; i++){
+        uint64_t x;
+        memcpy(&x, p, 8);
+        x ^= 0x3030303030303030ULL;  // Digits become 0..9
+        uint64_t other = (((x & 0x7f7f7f7f7f7f7f7fULL) + 0x7676767676767676ULL) | x) & 0x8080808080808080ULL;
+        int      len   = other ? __builtin_ctzll(other) >> 3 : 8;
+        if (len == 0) break;
+
+        // Combine the digits pairwise, first in the lowest byte:
+        x <<= 8 * (8 - len);
+        x = ((x & 0x0f0f0f0f0f0f0f0fULL) * 2561) >> 8;
+        x = ((x & 0x00ff00ff00ff00ffULL) * 6553601) >> 16;
+        x = ((x & 0x0000ffff0000ffffULL) * 42949672960001ULL) >> 32;
+        val = val * pow10[len] + x;
+        p  += len;
+        if (len < 8) break;
+    }
+    if (p == digits) fprintf(stderr, "PARSE ERROR! Unexpected char: %c\n", *p), exit(3);
+
+    in.skip(p - in.data());
+    return neg ? -(int)val : (int)val;
+#else
+    return parseInt<B>(in);
+#endif
+}
+
+static inline int parseInt(InputBuffer&  in) { return parseIntWindow(in); }
+static inline int parseInt(MemoryBuffer& in) { return parseIntWindow(in); }
+
+
 // String matching: in case of a match the input iterator will be advanced the corresponding
 // number of characters.
 template<class B>